@@ -0,0 +1,48 @@
+#define DOCTEST_CONFIG_DISABLE
+#include <doctest.h>
+
+#define ANKERL_NANOBENCH_IMPLEMENT
+#include <nanobench.h>
+
+#include <iostream>
+#include <string>
+
+#include "bench/engines.hpp"
+#include "bench/external.hpp"
+#include "bench/nodeids.hpp"
+#include "bench/prefetch.hpp"
+#include "calibrate.hpp"
+#include "bench/scaling.hpp"
+#include "bench/warmstart.hpp"
+#include "utils/args.hpp"
+
+// usage: bench -suite <name> [suite options]
+int main(int argc, char *argv[]) {
+  Args args(argc, argv);
+  std::string suite = args.getString("-suite", "scaling");
+
+  if (suite == "calibrate") {
+    // -profile <path> saves the result
+    Thresholds t = calibrateThresholds();
+    std::cout << t << std::endl;
+    std::string profile = args.getString("-profile", "");
+    if (!profile.empty()) saveThresholds(profile, t);
+  } else if (suite == "engines") {
+    benchEngines(args);
+  } else if (suite == "external") {
+    benchExternal(args);
+  } else if (suite == "nodeids") {
+    benchNodeIds(args);
+  } else if (suite == "prefetch") {
+    benchPrefetch(args);
+  } else if (suite == "scaling") {
+    benchScaling(args);
+  } else if (suite == "warmstart") {
+    benchWarmStart(args);
+  } else {
+    std::cout << "Unknown suite: " << suite << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
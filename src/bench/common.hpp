@@ -0,0 +1,56 @@
+#pragma once
+
+#include <nanobench.h>
+
+#include <string>
+
+#include "../calibrate.hpp"
+#include "../graphgen/randomgraphs.hpp"
+#include "../utils/args.hpp"
+#include "../utils/graph.hpp"
+#include "../utils/random.hpp"
+
+// generates one of the graph families used in the report:
+// "random", "onelong" or "geometric"
+static inline void makeGraph(Random &rnd, const std::string &type, int N,
+                             i64 M, Edges &edges) {
+  if (type == "random") {
+    randomGraph(rnd, N, M, 1.0, edges);
+  } else if (type == "onelong") {
+    randomGraphOneLong(rnd, N, M, 1.0, edges);
+  } else if (type == "geometric") {
+    randomGeometricGraphSeq(rnd, N, M, 1.0, edges);
+  } else {
+    std::cout << "Unknown graph type: " << type << std::endl;
+    unreachable();
+  }
+}
+
+// base cases from the profile given with -profile <path>, the machine is
+// calibrated if the profile does not exist yet
+static inline Thresholds benchThresholds(Args &args) {
+  std::string profile = args.getString("-profile", "");
+  if (profile.empty()) return Thresholds();
+  Thresholds t = loadOrCalibrate(profile);
+  std::cout << "Thresholds: " << t << std::endl;
+  return t;
+}
+
+static inline ankerl::nanobench::Bench makeBench(const std::string &title) {
+  ankerl::nanobench::Bench bench;
+  bench.title(title).timeUnit(std::chrono::milliseconds(1), "ms");
+  return bench;
+}
+
+// runs mstFn(edges) on a fresh copy of the edges at every iteration, the edge
+// list can be a vector of any edge type or SoaEdges
+template <class EdgeList, class F>
+static inline void benchMst(ankerl::nanobench::Bench &bench,
+                            const std::string &name, const EdgeList &edges,
+                            F &&mstFn) {
+  bench.run(name, [&] {
+    EdgeList edgesCopy = edges;
+    auto mst = mstFn(edgesCopy);
+    ankerl::nanobench::doNotOptimizeAway(mst);
+  });
+}
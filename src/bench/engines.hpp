@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../adaptivekruskal.hpp"
+#include "../dualpivotkruskal.hpp"
+#include "../fatfilterkruskal.hpp"
+#include "../filterkruskal.hpp"
+#include "../histogramkruskal.hpp"
+#include "../keykruskal.hpp"
+#include "../kruskal.hpp"
+#include "../msfkruskal.hpp"
+#include "../quickkruskal.hpp"
+#include "../radixkruskal.hpp"
+#include "../samplesortkruskal.hpp"
+#include "../skewedfilterkruskal.hpp"
+#include "../soakruskal.hpp"
+#include "../streamingkruskal.hpp"
+#include "common.hpp"
+
+typedef std::function<Edges(Edges &, int)> MstFn;
+
+// every sequential MST engine on Edges, by name. soaFilterKruskal runs on
+// its own edge list, see benchEngines
+// options: -skewk <k> -noskewinner -chunk <edges per streamed chunk>
+//          -maxruns <runs merged by adaptiveKruskal>
+static inline std::vector<std::pair<std::string, MstFn>> allEngines(
+    Args &args, const Thresholds &t) {
+  double skewK = args.getDouble("-skewk", 1.1);
+  bool skewInner = !args.getBool("-noskewinner");
+  u64 chunk = args.getDouble("-chunk", 1 << 20);
+  u64 maxRuns = args.getDouble("-maxruns", ADAPTIVE_MAX_RUNS);
+  return {
+      {"kruskal", [](Edges &e, int N) { return kruskal(e, N); }},
+      {"filterKruskal",
+       [=](Edges &e, int N) { return filterKruskal(e, N, t.filterKruskal); }},
+      {"filterKruskalPool",
+       [=](Edges &e, int N) {
+         return filterKruskalPool(e, N, t.filterKruskal);
+       }},
+      {"sampleSortKruskal",
+       [=](Edges &e, int N) { return sampleSortKruskal(e, N, t.sampleSort); }},
+      {"dualPivotFilterKruskal",
+       [=](Edges &e, int N) {
+         return dualPivotFilterKruskal(e, N, t.filterKruskal);
+       }},
+      {"fatFilterKruskal",
+       [=](Edges &e, int N) {
+         return fatFilterKruskal(e, N, t.filterKruskal);
+       }},
+      {"skewedFilterKruskal",
+       [=](Edges &e, int N) {
+         return skewedFilterKruskal(e, N, skewK, skewInner, t.filterKruskal);
+       }},
+      {"radixFilterKruskal",
+       [=](Edges &e, int N) { return radixFilterKruskal(e, N, t.radix); }},
+      {"keyFilterKruskal",
+       [=](Edges &e, int N) { return keyFilterKruskal(e, N, t.key); }},
+      {"adaptiveKruskal",
+       [=](Edges &e, int N) {
+         return adaptiveKruskal(e, N, t.filterKruskal, maxRuns);
+       }},
+      {"quickKruskal",
+       [=](Edges &e, int N) { return quickKruskal(e, N, t.quick); }},
+      {"histogramKruskal",
+       [=](Edges &e, int N) { return histogramKruskal(e, N, t.histogram); }},
+      {"msfFilterKruskal",
+       [=](Edges &e, int N) {
+         return msfFilterKruskal(e, N, hardwareThreads(), t.filterKruskal)
+             .edges;
+       }},
+      {"streamingKruskal",
+       [=](Edges &e, int N) {
+         StreamingKruskal stream(N, t.filterKruskal);
+         for (u64 i = 0; i < e.size(); i += chunk) {
+           u64 end = std::min(i + chunk, (u64)e.size());
+           stream.addChunk(e.data() + i, e.data() + end);
+         }
+         return stream.msf();
+       }},
+  };
+}
+
+// runs the engines on graphs with a fixed number of nodes and growing density
+// options: -graph <type|all> -engines <name,name,...|all> -n <nodes>
+//          -minm <edges> -maxm <edges> -levels <distinct weights>
+//          -sorted (the edges are given sorted by weight) -profile <path>
+static inline void benchEngines(Args &args) {
+  Thresholds t = benchThresholds(args);
+  auto engines = allEngines(args, t);
+  std::string graph = args.getString("-graph", "all");
+  std::string names = "," + args.getString("-engines", "all") + ",";
+  int N = args.getInt("-n", 60000);
+  double minM = args.getDouble("-minm", 1e5);
+  double maxM = args.getDouble("-maxm", 1e7);
+  int levels = args.getInt("-levels", 0);
+  bool sorted = args.getBool("-sorted");
+
+  std::vector<std::string> types = {"random", "onelong", "geometric"};
+  if (graph != "all") types = {graph};
+
+  for (const std::string &type : types) {
+    for (double M = minM; M <= maxM; M *= 10) {
+      Random rnd(23);
+      Edges edges;
+      makeGraph(rnd, type, N, M, edges);
+      if (levels > 0) {
+        float maxw = 0;
+        for (const Edge &e : edges) maxw = std::max(maxw, e.w);
+        quantizeWeights(edges, maxw, levels);
+      }
+      if (sorted) std::sort(edges.begin(), edges.end());
+
+      auto bench = makeBench(type + " N=" + std::to_string(N) +
+                             " M=" + std::to_string(edges.size()));
+      auto selected = [&](const std::string &name) {
+        return names == ",all," ||
+               names.find("," + name + ",") != std::string::npos;
+      };
+      for (const auto &engine : engines) {
+        if (!selected(engine.first)) continue;
+        benchMst(bench, engine.first, edges,
+                 [&](Edges &e) { return engine.second(e, N); });
+      }
+
+      // the edges are converted once, outside of the timing, and copied at
+      // every iteration like the Edges of the other engines
+      if (selected("soaFilterKruskal")) {
+        SoaEdges soa(edges);
+        benchMst(bench, "soaFilterKruskal", soa, [&](SoaEdges &e) {
+          return soaFilterKruskal(e, N, t.filterKruskal);
+        });
+      }
+    }
+  }
+}
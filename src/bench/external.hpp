@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../externalkruskal.hpp"
+#include "../filterkruskal.hpp"
+#include "common.hpp"
+
+// externalFilterKruskal with memory budgets of the given sizes against
+// filterKruskal in memory. the graph is written to a temporary file once,
+// before the timing
+// options: -graph <type> -n <nodes> -m <edges> -budgets <MB,MB,...>
+//          -tmpdir <path> -profile <path>
+static inline void benchExternal(Args &args) {
+  Thresholds t = benchThresholds(args);
+  std::string type = args.getString("-graph", "random");
+  int N = args.getDouble("-n", 1 << 20);
+  i64 M = args.getDouble("-m", 1 << 24);
+  std::string tmpDir = args.getString("-tmpdir", ".");
+
+  std::vector<double> budgets;
+  std::istringstream list(args.getString("-budgets", "16,64,256"));
+  for (std::string b; std::getline(list, b, ',');) {
+    budgets.push_back(std::stod(b));
+  }
+
+  Random rnd(23);
+  Edges edges;
+  makeGraph(rnd, type, N, M, edges);
+  FILE *file = openTmpEdgeFile(tmpDir);
+  writeEdges(file, edges.data(), edges.size());
+
+  auto bench = makeBench("external " + type + " N=" + std::to_string(N) +
+                         " M=" + std::to_string(edges.size()));
+  bench.epochs(3);
+  benchMst(bench, "filterKruskal", edges,
+           [&](Edges &e) { return filterKruskal(e, N, t.filterKruskal); });
+  for (double mb : budgets) {
+    bench.run("externalFilterKruskal " + std::to_string(int(mb)) + "MB", [&] {
+      ankerl::nanobench::doNotOptimizeAway(externalFilterKruskal(
+          file, N, mb * (1 << 20), tmpDir, t.filterKruskal));
+    });
+  }
+  fclose(file);
+}
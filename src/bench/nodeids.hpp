@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../filterkruskal.hpp"
+#include "../graphgen/randomgraphs.hpp"
+#include "../kruskal.hpp"
+#include "common.hpp"
+
+// filterKruskal with 32 and 64 bit node ids on the same random graph, both
+// fit up to 2^32 nodes so they can be compared at the 2^31 boundary with
+// -n 2147483648 (the 64 bit edges take 24 bytes instead of 12)
+// options: -n <nodes> -m <edges>
+static inline void benchNodeIds(Args &args) {
+  i64 N = args.getDouble("-n", 1 << 24);
+  i64 M = args.getDouble("-m", 1 << 26);
+
+  Random rnd(23);
+  std::vector<BasicEdge<u32, float>> edges;
+  randomGraph(rnd, N, M, 1.0, edges);
+  std::vector<BasicEdge<u64, float>> wideEdges;
+  wideEdges.reserve(edges.size());
+  for (const auto &e : edges) wideEdges.emplace_back(e.a, e.b, e.w);
+
+  auto bench = makeBench("node ids, N=" + std::to_string(N) +
+                         " M=" + std::to_string(edges.size()));
+  bench.epochs(3);
+  benchMst(bench, "filterKruskal u32", edges,
+           [&](std::vector<BasicEdge<u32, float>> &e) {
+             return filterKruskal(e, N);
+           });
+  benchMst(bench, "filterKruskal u64", wideEdges,
+           [&](std::vector<BasicEdge<u64, float>> &e) {
+             return filterKruskal(e, N);
+           });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../filterkruskal.hpp"
+#include "../kruskal.hpp"
+#include "../prefetchkruskal.hpp"
+#include "common.hpp"
+
+// the prefetch distance of the pipelined engines on random graphs with
+// N = minn, 10 minn, ... maxn nodes and degree * N edges
+// options: -minn <nodes> -maxn <nodes> -degree <edges per node>
+//          -distances <d,d,...> -profile <path>
+static inline void benchPrefetch(Args &args) {
+  Thresholds t = benchThresholds(args);
+  double minN = args.getDouble("-minn", 1e5);
+  double maxN = args.getDouble("-maxn", 1e8);
+  double degree = args.getDouble("-degree", 4);
+
+  std::vector<int> distances;
+  std::istringstream list(args.getString("-distances", "0,4,8,16,32,64"));
+  for (std::string d; std::getline(list, d, ',');) {
+    distances.push_back(std::stoi(d));
+  }
+
+  for (double N = minN; N <= maxN; N *= 10) {
+    Random rnd(23);
+    Edges edges;
+    randomGraph(rnd, N, N * degree, 1.0, edges);
+
+    auto bench = makeBench("prefetch N=" + std::to_string(u64(N)) +
+                           " M=" + std::to_string(edges.size()));
+    bench.epochs(3);
+    benchMst(bench, "filterKruskal", edges,
+             [&](Edges &e) { return filterKruskal(e, N, t.filterKruskal); });
+    for (int d : distances) {
+      std::string suffix = " d=" + std::to_string(d);
+      benchMst(bench, "kruskalPrefetch" + suffix, edges, [&](Edges &e) {
+        DisjointSet set(N);
+        Edges mst;
+        kruskalPrefetch(set, e.begin(), e.end(), N, true, mst, d);
+        return mst;
+      });
+      benchMst(bench, "prefetchFilterKruskal" + suffix, edges,
+               [&](Edges &e) {
+                 return prefetchFilterKruskal(e, N, d, t.filterKruskal);
+               });
+    }
+  }
+}
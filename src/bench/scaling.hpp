@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+#include "../filterkruskal.hpp"
+#include "../parallelfilterkruskal.hpp"
+#include "../parallelsamplesortkruskal.hpp"
+#include "common.hpp"
+
+// the parallel engines with 1, 2, 4, ... maxthreads threads
+// options: -graph <type> -n <nodes> -m <edges> -maxthreads <threads>
+//          -profile <path>
+static inline void benchScaling(Args &args) {
+  Thresholds t = benchThresholds(args);
+  std::string type = args.getString("-graph", "random");
+  int N = args.getInt("-n", 1000000);
+  i64 M = args.getDouble("-m", 1e8);
+  int maxThreads = args.getInt("-maxthreads", 64);
+
+  Random rnd(23);
+  Edges edges;
+  makeGraph(rnd, type, N, M, edges);
+
+  auto bench = makeBench("parallel scaling, " + type);
+  bench.epochs(3);
+  benchMst(bench, "filterKruskal", edges,
+           [&](Edges &e) { return filterKruskal(e, N, t.filterKruskal); });
+  for (int nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+    benchMst(bench, "parallelFilterKruskal t=" + std::to_string(nThreads),
+             edges,
+             [&](Edges &e) {
+               return parallelFilterKruskal(e, N, nThreads, t.filterKruskal);
+             });
+    benchMst(bench, "parallelSampleSortKruskal t=" + std::to_string(nThreads),
+             edges, [&](Edges &e) {
+               return parallelSampleSortKruskal(e, N, nThreads,
+                                                t.filterKruskal);
+             });
+  }
+}
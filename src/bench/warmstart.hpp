@@ -0,0 +1,64 @@
+#pragma once
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../filterkruskal.hpp"
+#include "../utils/timer.hpp"
+#include "../warmkruskal.hpp"
+#include "common.hpp"
+
+// repeated MSTs of one graph while the node potentials take random steps of
+// the given sizes, filterKruskal from scratch against WarmKruskal.
+// a copy of the edge list with the new weights is made for filterKruskal
+// before its timer starts, as WarmKruskal gets the new weights before its
+// timer starts. nanobench can not leave that copy out of the timing, so the
+// runs are timed here
+// options: -graph <type> -n <nodes> -m <edges> -steps <s,s,...> -reps <runs>
+static inline void benchWarmStart(Args &args) {
+  Thresholds t = benchThresholds(args);
+  std::string type = args.getString("-graph", "random");
+  i64 N = args.getDouble("-n", 1 << 20);
+  i64 M = args.getDouble("-m", 1 << 24);
+  int reps = args.getInt("-reps", 10);
+
+  std::vector<float> steps;
+  std::istringstream list(args.getString("-steps", "0.00001,0.001,0.1"));
+  for (std::string s; std::getline(list, s, ',');) {
+    steps.push_back(std::stof(s));
+  }
+
+  Random rnd(23);
+  Edges edges;
+  makeGraph(rnd, type, N, M, edges);
+  WarmKruskal warm(edges, N, t.filterKruskal);
+  std::vector<float> pi(N, 0), weights;
+  Edges fresh;
+
+  std::cout << "warm start " << type << " N=" << N << " M=" << edges.size()
+            << ", average ms of " << reps << " runs" << std::endl;
+  std::cout << std::setw(12) << "step" << std::setw(16) << "filterKruskal"
+            << std::setw(16) << "WarmKruskal" << std::endl;
+  for (float step : steps) {
+    Timer<> cold, hot;
+    for (int r = 0; r < reps; r++) {
+      for (float &p : pi) p += (rnd.getFloat() - 0.5f) * step;
+      potentialWeights(edges, pi, weights);
+      fresh = edges;
+      for (u64 i = 0; i < fresh.size(); i++) fresh[i].w = weights[i];
+
+      cold.start();
+      ankerl::nanobench::doNotOptimizeAway(
+          filterKruskal(fresh, N, t.filterKruskal));
+      cold.delta();
+
+      hot.start();
+      ankerl::nanobench::doNotOptimizeAway(warm.solve(weights));
+      hot.delta();
+    }
+    std::cout << std::setw(12) << step << std::setw(16) << cold.avg() * 1000
+              << std::setw(16) << hot.avg() * 1000 << std::endl;
+  }
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "histogramkruskal.hpp"
+#include "keykruskal.hpp"
+#include "kruskal.hpp"
+#include "optimalpivot.hpp"
+#include "quickkruskal.hpp"
+#include "radixkruskal.hpp"
+#include "samplesortkruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+#include "utils/timer.hpp"
+
+// base case sizes of the Filter-Kruskal variants
+struct Thresholds {
+  u64 filterKruskal = FILTER_KRUSKAL_BASE_CASE;  // single and dual pivot
+  u64 seeded = SEEDED_BASE_CASE;
+  u64 sampleSort = SAMPLESORT_BASE_CASE;
+  u64 radix = RADIX_BASE_CASE;
+  u64 key = KEY_BASE_CASE;
+  u64 histogram = HISTOGRAM_BUCKET_SIZE;
+  u64 quick = FILTER_KRUSKAL_BASE_CASE;
+};
+
+// best of reps runs of fn on a fresh copy of the edges, in seconds
+static inline double timeMin(
+    const Edges &edges, int N, int reps,
+    const std::function<void(DisjointSet &, Edges &, Edges &)> &fn) {
+  Timer<> timer;
+  double best = 1e30;
+  Edges copy;
+  Edges mst;
+  for (int r = 0; r < reps; r++) {
+    copy = edges;
+    mst.clear();
+    DisjointSet set(N);
+    timer.start();
+    fn(set, copy, mst);
+    best = std::min(best, timer.delta());
+  }
+  return best;
+}
+
+// finds the smallest size, in steps of powers of two, where one partitioning
+// step followed by base cases beats kruskal() on the whole range.
+// stepFn(set, edges, mst, baseCase) runs the variant with the given base case,
+// so with baseCase = M it does exactly one step.
+// the graph has average degree 8, so the step filters part of its right side
+static inline u64 calibrateStep(
+    const std::function<void(DisjointSet &, Edges &, Edges &, u64)> &stepFn,
+    u64 minSize = 64, u64 maxSize = 1 << 16) {
+  Random rnd(41);
+  for (u64 M = minSize; M <= maxSize; M *= 2) {
+    int N = M / 4;
+    Edges edges(M);
+    for (Edge &e : edges) {
+      e = Edge(rnd.getInt(N), rnd.getInt(N), rnd.getFloat());
+    }
+
+    int reps = std::max(u64(3), (1 << 20) / M);
+    double kruskalTime =
+        timeMin(edges, N, reps, [&](DisjointSet &set, Edges &e, Edges &mst) {
+          kruskal(set, e.begin(), e.end(), N, true, mst);
+        });
+    double stepTime =
+        timeMin(edges, N, reps, [&](DisjointSet &set, Edges &e, Edges &mst) {
+          stepFn(set, e, mst, M);
+        });
+    if (stepTime < kruskalTime) return M;
+  }
+  return maxSize;
+}
+
+// runs the whole variant on a random graph with every base case size, in
+// steps of powers of two, and returns the fastest one.
+// solveFn(set, edges, mst, baseCase) runs the variant
+static inline u64 calibrateSweep(
+    const std::function<void(DisjointSet &, Edges &, Edges &, u64)> &solveFn,
+    u64 minSize = 64, u64 maxSize = 1 << 16) {
+  Random rnd(41);
+  int N = 1 << 14;
+  Edges edges;
+  randomGraph(rnd, N, 1 << 20, 1.0, edges);
+
+  u64 best = minSize;
+  double bestTime = 1e30;
+  for (u64 baseCase = minSize; baseCase <= maxSize; baseCase *= 2) {
+    double time =
+        timeMin(edges, N, 5, [&](DisjointSet &set, Edges &e, Edges &mst) {
+          solveFn(set, e, mst, baseCase);
+        });
+    if (time < bestTime) {
+      best = baseCase;
+      bestTime = time;
+    }
+  }
+  return best;
+}
+
+// times the base cases made by kruskal() against the partitioning steps of
+// every variant
+static inline Thresholds calibrateThresholds() {
+  Thresholds t;
+  t.filterKruskal = calibrateSweep(
+      [](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        filterKruskal(set, edges.begin(), edges.end(), set.N, mst, bc);
+      });
+
+  Edges buffer;
+  std::vector<u8> oracle;
+  t.sampleSort = calibrateSweep(
+      [&](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        buffer.resize(edges.size());
+        oracle.resize(edges.size());
+        sampleSortKruskal(set, edges.begin(), edges.end(), set.N, mst,
+                          buffer.begin(), oracle.data(), bc);
+      });
+
+  t.radix = calibrateSweep(
+      [](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        radixFilterKruskal(set, edges.begin(), edges.end(), set.N, mst, bc);
+      });
+  t.key = calibrateSweep(
+      [](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        mst = keyFilterKruskal(edges, set.N, bc);
+      });
+  t.histogram = calibrateSweep(
+      [](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        mst = histogramKruskal(edges, set.N, bc);
+      });
+  t.quick = calibrateSweep(
+      [](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        quickKruskal(set, edges.begin(), edges.end(), set.N, mst, bc);
+      });
+
+  // the seeded pivots are computed for one recursion tree, so the base case
+  // can not change under them: time a single step with the median as pivot.
+  // the median is computed in the first of the timed runs of every size,
+  // which is discarded
+  Edges pivots(1);
+  u64 pivotsSize = 0;
+  t.seeded = calibrateStep(
+      [&](DisjointSet &set, Edges &edges, Edges &mst, u64 bc) {
+        if (pivotsSize != edges.size()) {
+          Edges copy = edges;
+          std::nth_element(copy.begin(), copy.begin() + copy.size() / 2,
+                           copy.end());
+          pivots[0] = copy[copy.size() / 2];
+          pivotsSize = edges.size();
+        }
+        EdgeIt nextPivot = pivots.begin();
+        filterKruskalSeeded(set, edges, 0, edges.size(), set.N, mst,
+                            nextPivot, bc);
+      });
+  return t;
+}
+
+static inline bool loadThresholds(const std::string &path, Thresholds &t) {
+  std::ifstream in(path);
+  if (!in) return false;
+
+  Thresholds loaded;
+  std::string name;
+  u64 value;
+  while (in >> name >> value) {
+    if (name == "filterKruskal")
+      loaded.filterKruskal = value;
+    else if (name == "seeded")
+      loaded.seeded = value;
+    else if (name == "sampleSort")
+      loaded.sampleSort = value;
+    else if (name == "radix")
+      loaded.radix = value;
+    else if (name == "key")
+      loaded.key = value;
+    else if (name == "histogram")
+      loaded.histogram = value;
+    else if (name == "quick")
+      loaded.quick = value;
+    else
+      return false;
+  }
+  if (!in.eof()) return false;
+  t = loaded;
+  return true;
+}
+
+static inline bool saveThresholds(const std::string &path,
+                                  const Thresholds &t) {
+  std::ofstream out(path);
+  out << "filterKruskal " << t.filterKruskal << std::endl;
+  out << "seeded " << t.seeded << std::endl;
+  out << "sampleSort " << t.sampleSort << std::endl;
+  out << "radix " << t.radix << std::endl;
+  out << "key " << t.key << std::endl;
+  out << "histogram " << t.histogram << std::endl;
+  out << "quick " << t.quick << std::endl;
+  return bool(out);
+}
+
+// reads the profile of this machine, or calibrates and saves it if there is
+// no valid profile yet
+static inline Thresholds loadOrCalibrate(const std::string &path) {
+  Thresholds t;
+  if (loadThresholds(path, t)) return t;
+  t = calibrateThresholds();
+  if (!saveThresholds(path, t)) {
+    std::cerr << "Could not write the profile " << path << std::endl;
+  }
+  return t;
+}
+
+static inline std::ostream &operator<<(std::ostream &out,
+                                       const Thresholds &t) {
+  out << "filterKruskal=" << t.filterKruskal << " seeded=" << t.seeded
+      << " sampleSort=" << t.sampleSort << " radix=" << t.radix
+      << " key=" << t.key << " histogram=" << t.histogram
+      << " quick=" << t.quick;
+  return out;
+}
+
+TEST_CASE("Thresholds profile") {
+  Thresholds t;
+  t.filterKruskal = 512;
+  t.seeded = 64;
+  t.sampleSort = 8192;
+  t.radix = 256;
+  t.key = 2048;
+  t.histogram = 1024;
+  t.quick = 128;
+
+  std::string path = "thresholds_test.profile";
+  REQUIRE(saveThresholds(path, t));
+  Thresholds loaded;
+  REQUIRE(loadThresholds(path, loaded));
+  CHECK(loaded.filterKruskal == 512);
+  CHECK(loaded.seeded == 64);
+  CHECK(loaded.sampleSort == 8192);
+  CHECK(loaded.radix == 256);
+  CHECK(loaded.key == 2048);
+  CHECK(loaded.histogram == 1024);
+  CHECK(loaded.quick == 128);
+  std::remove(path.c_str());
+
+  CHECK(loadThresholds(path, loaded) == false);
+}
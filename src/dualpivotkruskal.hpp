@@ -0,0 +1,75 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+
+// Filter-Kruskal with two pivots per recursion level, every level splits the
+// edges in three parts with partitionDual
+static inline void dualPivotFilterKruskal(DisjointSet &set, EdgeIt first,
+                                          EdgeIt last, int N, Edges &mst,
+                                          u64 baseCase =
+                                              FILTER_KRUSKAL_BASE_CASE) {
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  EdgeIt pivotPos1 = pickRandomPivot(first, last);
+  EdgeIt pivotPos2 = pickRandomPivot(first, last);
+  if (*pivotPos2 < *pivotPos1) std::iter_swap(pivotPos1, pivotPos2);
+  auto mids = partitionDual(first, last, pivotPos1->w, pivotPos2->w);
+  EdgeIt lt = mids.first, gt = mids.second;
+
+  dualPivotFilterKruskal(set, first, lt, N, mst, baseCase);
+
+  // the middle and right parts are filtered only when all the edges on their
+  // left have been processed
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos1, mst);
+  if (mst.size() < N - 1) {
+    EdgeIt middleLast = filterAll(set, lt, gt);
+    dualPivotFilterKruskal(set, lt, middleLast, N, mst, baseCase);
+  }
+
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos2, mst);
+  if (mst.size() < N - 1) {
+    last = filterAll(set, gt, last);
+    dualPivotFilterKruskal(set, gt, last, N, mst, baseCase);
+  }
+}
+
+static inline Edges dualPivotFilterKruskal(
+    Edges &edges, int N, u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  dualPivotFilterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst;
+}
+
+TEST_CASE("partitionDual") {
+  Random rnd(17);
+  Edges edges;
+  randomGraph(rnd, 100, 2000, 1.0, edges);
+  auto mids = partitionDual(edges.begin(), edges.end(), 0.3, 0.6);
+  CHECK(std::all_of(edges.begin(), mids.first,
+                    [](const Edge &e) { return e.w < 0.3f; }));
+  CHECK(std::all_of(mids.first, mids.second, [](const Edge &e) {
+    return e.w >= 0.3f && e.w < 0.6f;
+  }));
+  CHECK(std::all_of(mids.second, edges.end(),
+                    [](const Edge &e) { return e.w >= 0.6f; }));
+}
+
+TEST_CASE("dualPivotFilterKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return dualPivotFilterKruskal(edges, N); },
+      19);
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+
+// Filter-Kruskal for edge lists stored in a file, as a raw array of Edge, that
+// do not fit in memory.
+// the edges are distributed in buckets by sampled splitters (first read),
+// then the buckets are read back in order (second read): every edge is
+// filtered while it is streamed in, and the survivors of the bucket are
+// solved in memory with filterKruskal. buckets whose survivors do not fit in
+// memory are written to a new file and split again.
+// every splitter also gets a bucket for the edges equal to it, these buckets
+// are already sorted and are streamed through kruskal() in chunks, so the
+// splitting always makes progress.
+// all the buckets of a split share one temporary file, where every bucket is
+// a list of blocks. the temporary files get unique names in tmpDir and the
+// names are removed as soon as the files are open, so the files are deleted
+// when they are closed or the process ends, also on errors
+
+static const u64 EXTERNAL_MAX_SPLITTERS = 255;
+static const u64 EXTERNAL_OVERSAMPLING = 16;
+
+static inline FILE *openEdgeFile(const std::string &path, const char *mode) {
+  FILE *file = fopen(path.c_str(), mode);
+  if (!file) {
+    std::cerr << "Could not open " << path << std::endl;
+    unreachable();
+  }
+  return file;
+}
+
+// a file for reading and writing without a name in dir
+static inline FILE *openTmpEdgeFile(const std::string &dir) {
+  std::string path = dir + "/filterkruskal_XXXXXX";
+  int fd = mkstemp(&path[0]);
+  FILE *file = fd < 0 ? nullptr : fdopen(fd, "w+b");
+  if (!file) {
+    std::cerr << "Could not create a temporary file in " << dir << std::endl;
+    unreachable();
+  }
+  unlink(path.c_str());
+  return file;
+}
+
+// number of edges in the file
+static inline u64 edgeFileSize(FILE *file) {
+  fseeko(file, 0, SEEK_END);
+  u64 size = ftello(file) / sizeof(Edge);
+  fseeko(file, 0, SEEK_SET);
+  return size;
+}
+
+static inline void writeEdges(FILE *file, const Edge *edges, u64 n) {
+  if (n > 0 && fwrite(edges, sizeof(Edge), n, file) != n) {
+    std::cerr << "Could not write the edges" << std::endl;
+    unreachable();
+  }
+}
+
+static inline void writeEdges(const std::string &path, const Edges &edges) {
+  FILE *file = openEdgeFile(path, "wb");
+  writeEdges(file, edges.data(), edges.size());
+  fclose(file);
+}
+
+// reads up to n edges, the vector is resized to the number of edges read
+static inline void readEdges(FILE *file, Edges &edges, u64 n) {
+  edges.resize(n);
+  edges.resize(fread(edges.data(), sizeof(Edge), n, file));
+}
+
+// the blocks of a bucket in the file of its split, as positions in edges
+struct EdgeBucket {
+  std::vector<std::pair<u64, u64>> blocks;  // first edge, number of edges
+  u64 size = 0;
+
+  void add(u64 first, u64 n) {
+    if (n == 0) return;
+    blocks.emplace_back(first, n);
+    size += n;
+  }
+};
+
+struct ExternalKruskal {
+  u64 N;
+  DisjointSet set;
+  Edges mst;
+  u64 budget;  // edges that can be kept in memory
+  std::string tmpDir;
+  u64 baseCase;  // of the in-memory filterKruskal
+  Random rnd;
+
+  ExternalKruskal(u64 N, u64 memoryBudget, const std::string &tmpDir,
+                  u64 baseCase = FILTER_KRUSKAL_BASE_CASE)
+      : N(N),
+        set(N),
+        budget(std::max(memoryBudget / sizeof(Edge), u64(1024))),
+        tmpDir(tmpDir),
+        baseCase(baseCase),
+        rnd(47) {}
+
+  bool done() { return mst.size() == N - 1; }
+
+  // sorted splitters without duplicates, read from random positions
+  std::vector<float> pickSplitters(FILE *file, u64 M, u64 nSplitters) {
+    std::vector<float> samples(nSplitters * EXTERNAL_OVERSAMPLING);
+    Edge e;
+    for (float &w : samples) {
+      fseeko(file, rnd.getULong(M) * sizeof(Edge), SEEK_SET);
+      if (fread(&e, sizeof(Edge), 1, file) != 1) unreachable();
+      w = e.w;
+    }
+    fseeko(file, 0, SEEK_SET);
+    std::sort(samples.begin(), samples.end());
+
+    std::vector<float> splitters;
+    for (u64 i = 1; i <= nSplitters; i++) {
+      float w = samples[i * samples.size() / (nSplitters + 1)];
+      if (splitters.empty() || splitters.back() < w) splitters.push_back(w);
+    }
+    return splitters;
+  }
+
+  // bucket 2i holds the weights between splitter i - 1 and splitter i,
+  // bucket 2i + 1 holds the weights equal to splitter i
+  static int classify(const std::vector<float> &splitters, float w) {
+    int i = std::lower_bound(splitters.begin(), splitters.end(), w) -
+            splitters.begin();
+    return 2 * i + (i < (int)splitters.size() && splitters[i] == w);
+  }
+
+  // first read: distributes the M edges of the file in the buckets, which
+  // are written to out
+  std::vector<EdgeBucket> distribute(FILE *in, u64 M,
+                                     const std::vector<float> &splitters,
+                                     FILE *out) {
+    int nBuckets = 2 * splitters.size() + 1;
+    std::vector<EdgeBucket> buckets(nBuckets);
+    u64 written = 0;
+    auto flush = [&](int b, Edges &staging) {
+      writeEdges(out, staging.data(), staging.size());
+      buckets[b].add(written, staging.size());
+      written += staging.size();
+      staging.clear();
+    };
+
+    // half of the budget for the input, half for the output buffers
+    u64 stagingSize = std::max(budget / 2 / nBuckets, u64(64));
+    std::vector<Edges> staging(nBuckets);
+    for (Edges &s : staging) s.reserve(stagingSize);
+
+    Edges chunk;
+    for (u64 read = 0; read < M; read += chunk.size()) {
+      readEdges(in, chunk, std::min(budget / 2, M - read));
+      if (chunk.empty()) unreachable();
+      for (const Edge &e : chunk) {
+        int b = classify(splitters, e.w);
+        staging[b].push_back(e);
+        if (staging[b].size() == stagingSize) flush(b, staging[b]);
+      }
+    }
+    for (int b = 0; b < nBuckets; b++) flush(b, staging[b]);
+    return buckets;
+  }
+
+  // second read: filters the bucket while streaming it, and solves the
+  // survivors in memory or in a new file if they do not fit
+  void solveBucket(FILE *file, const EdgeBucket &bucket, bool sorted) {
+    Edges survivors, chunk;
+    FILE *spill = nullptr;
+    u64 spilled = 0;
+
+    for (const auto &block : bucket.blocks) {
+      if (done()) break;
+      fseeko(file, block.first * sizeof(Edge), SEEK_SET);
+      for (u64 read = 0; read < block.second && !done();
+           read += chunk.size()) {
+        readEdges(file, chunk, std::min(budget / 2, block.second - read));
+        if (chunk.empty()) unreachable();
+        EdgeIt last = filterAll(set, chunk.begin(), chunk.end());
+
+        if (sorted) {
+          // all the weights are equal, the chunk can be scanned right away
+          kruskal(set, chunk.begin(), last, N, false, mst);
+          continue;
+        }
+
+        survivors.insert(survivors.end(), chunk.begin(), last);
+        if (survivors.size() > budget / 2) {
+          if (!spill) spill = openTmpEdgeFile(tmpDir);
+          writeEdges(spill, survivors.data(), survivors.size());
+          spilled += survivors.size();
+          survivors.clear();
+        }
+      }
+    }
+
+    if (spill) {
+      writeEdges(spill, survivors.data(), survivors.size());
+      spilled += survivors.size();
+      fseeko(spill, 0, SEEK_SET);
+      solve(spill, spilled);
+      fclose(spill);
+    } else {
+      filterKruskal(set, survivors.begin(), survivors.end(), N, mst,
+                    baseCase);
+    }
+  }
+
+  // solves the M edges stored at the start of the file, the file is left
+  // open
+  void solve(FILE *in, u64 M) {
+    if (M == 0 || done()) return;
+
+    if (M <= budget) {
+      Edges edges;
+      readEdges(in, edges, M);
+      EdgeIt last = filterAll(set, edges.begin(), edges.end());
+      return filterKruskal(set, edges.begin(), last, N, mst, baseCase);
+    }
+
+    // every bucket should take about half of the budget
+    u64 nSplitters = std::min(2 * M / budget, EXTERNAL_MAX_SPLITTERS);
+    std::vector<float> splitters = pickSplitters(in, M, nSplitters);
+    FILE *out = openTmpEdgeFile(tmpDir);
+    std::vector<EdgeBucket> buckets = distribute(in, M, splitters, out);
+
+    for (size_t b = 0; b < buckets.size() && !done(); b++) {
+      solveBucket(out, buckets[b], b % 2 == 1);
+    }
+    fclose(out);
+  }
+};
+
+// the edges of the file are solved using about memoryBudget bytes for the
+// edges, the temporary files are written in tmpDir
+static inline Edges externalFilterKruskal(
+    FILE *file, u64 N, u64 memoryBudget, const std::string &tmpDir = ".",
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  ExternalKruskal solver(N, memoryBudget, tmpDir, baseCase);
+  u64 M = edgeFileSize(file);
+  solver.solve(file, M);
+  return solver.mst;
+}
+
+static inline Edges externalFilterKruskal(
+    const std::string &path, u64 N, u64 memoryBudget,
+    const std::string &tmpDir = ".",
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  FILE *file = openEdgeFile(path, "rb");
+  Edges mst = externalFilterKruskal(file, N, memoryBudget, tmpDir, baseCase);
+  fclose(file);
+  return mst;
+}
+
+TEST_CASE("externalFilterKruskal") {
+  Random rnd(53);
+  int N = 2000;
+  for (int levels : {0, 16}) {
+    Edges edges;
+    randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+    if (levels > 0) quantizeWeights(edges, 1.0, levels);
+    // the input is a temporary file too, so the test leaves no files
+    FILE *file = openTmpEdgeFile(".");
+    writeEdges(file, edges.data(), edges.size());
+    Edges expected = kruskal(edges, N);
+
+    // about 3000 edges in memory
+    Edges mst = externalFilterKruskal(file, N, 3000 * sizeof(Edge));
+    fclose(file);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(expected));
+  }
+}
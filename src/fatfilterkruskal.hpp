@@ -0,0 +1,51 @@
+#pragma once
+
+#include <doctest.h>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+
+// filterKruskal with a three way partition: the edges with the same weight of
+// the pivot are already sorted, so they are scanned once by kruskal() and
+// never go through the recursion again. with few distinct weights the
+// recursion depth is bounded by their number
+static inline void fatFilterKruskal(DisjointSet &set, EdgeIt first,
+                                    EdgeIt last, int N, Edges &mst,
+                                    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  EdgeIt pivotPos = pickRandomPivot(first, last);
+  auto mids = partitionFat(first, last, pivotPos->w);
+  EdgeIt lt = mids.first, gt = mids.second;
+
+  fatFilterKruskal(set, first, lt, N, mst, baseCase);
+
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos, mst);
+  if (mst.size() < N - 1) kruskal(set, lt, gt, N, false, mst);
+  if (mst.size() < N - 1) {
+    last = filterAll(set, gt, last);
+    fatFilterKruskal(set, gt, last, N, mst, baseCase);
+  }
+}
+
+static inline Edges fatFilterKruskal(Edges &edges, int N,
+                                     u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  fatFilterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst;
+}
+
+TEST_CASE("fatFilterKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return fatFilterKruskal(edges, N); }, 43,
+      {1, 4, 256, 65536});
+}
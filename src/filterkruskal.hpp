@@ -1,20 +1,28 @@
 #pragma once
 
+#include <doctest.h>
+
 #include <algorithm>
 
+#include "graphgen/randomgraphs.hpp"
 #include "kruskal.hpp"
 #include "partition.hpp"
 #include "pivot.hpp"
 #include "unionfind.hpp"
 #include "utils/graph.hpp"
 
-static inline bool filter(DisjointSet &set, int a, int b) {
+// ranges with fewer edges than the base case are solved by kruskal()
+static const u64 FILTER_KRUSKAL_BASE_CASE = 1000;
+
+template <class Set, class NodeId>
+static inline bool filter(Set &set, NodeId a, NodeId b) {
   return set.compare(a, b);
 }
 
-static inline EdgeIt filterAll(DisjointSet &set, EdgeIt first, EdgeIt last) {
+template <class Set, class It>
+static inline It filterAll(Set &set, It first, It last) {
   while (first < last) {
-    const Edge &e = *first;
+    const auto &e = *first;
     if (filter(set, e.a, e.b)) {
       *first = *(--last);
     } else {
@@ -24,27 +32,119 @@ static inline EdgeIt filterAll(DisjointSet &set, EdgeIt first, EdgeIt last) {
   return last;
 }
 
-static inline void filterKruskal(DisjointSet &set, EdgeIt first, EdgeIt last,
-                                 int N, Edges &mst) {
+// Set, the iterators and the MST can use any edge and node id type
+template <class Set, class It, class Mst>
+static inline void filterKruskal(Set &set, It first, It last, u64 N, Mst &mst,
+                                 u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
   u64 M = last - first;
   if (M == 0) return;
-  if (M < 1000) return kruskal(set, first, last, N, true, mst);
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
 
-  EdgeIt pivotPos = pickRandomPivot(first, last);
-  EdgeIt mid = partition(first, last, pivotPos->w);
+  It pivotPos = pickRandomPivot(first, last);
+  It mid = partitionLess(first, last, pivotPos->w);
 
-  filterKruskal(set, first, mid, N, mst);
+  filterKruskal(set, first, mid, N, mst, baseCase);
 
   if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos, mst);
   if (mst.size() < N - 1) {
     last = filterAll(set, mid, last);
-    filterKruskal(set, mid, last, N, mst);
+    filterKruskal(set, mid, last, N, mst, baseCase);
+  }
+}
+
+template <class E>
+static inline std::vector<E> filterKruskal(
+    std::vector<E> &edges, u64 N, u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  EdgeDisjointSet<E> set(N);
+  std::vector<E> mst;
+  filterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst;
+}
+
+// filterKruskal where the pivots come from a PivotPool: [sl, sr) is the part of
+// the pool that falls in the range [first, last), its median is the pivot.
+// once the range of the pool is used up it falls back to random pivots
+static inline void filterKruskalPool(DisjointSet &set, EdgeIt first,
+                                     EdgeIt last, int N, Edges &mst,
+                                     const PivotPool &pool, u64 sl, u64 sr,
+                                     u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  if (sl == sr) return filterKruskal(set, first, last, N, mst, baseCase);
+
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  // the pivot is only a weight, every edge goes to one of the two sides
+  u64 sm = sl + (sr - sl) / 2;
+  EdgeIt mid = partition(first, last, pool.weights[sm]);
+
+  filterKruskalPool(set, first, mid, N, mst, pool, sl, sm, baseCase);
+
+  if (mst.size() < N - 1) {
+    last = filterAll(set, mid, last);
+    filterKruskalPool(set, mid, last, N, mst, pool, sm + 1, sr, baseCase);
   }
 }
 
-static inline Edges filterKruskal(Edges &edges, int N) {
+static inline Edges filterKruskalPool(Edges &edges, int N,
+                                      u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
   DisjointSet set(N);
   Edges mst;
-  filterKruskal(set, edges.begin(), edges.end(), N, mst);
+  if (edges.empty()) return mst;
+  PivotPool pool(edges.begin(), edges.end());
+  filterKruskalPool(set, edges.begin(), edges.end(), N, mst, pool, 0,
+                    pool.weights.size(), baseCase);
   return mst;
 }
+
+TEST_CASE("filterKruskal") {
+  Random rnd(37);
+  int N = 2000;
+  Edges edges;
+  randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  copy = edges;
+  Edges mst = filterKruskal(copy, N);
+  CHECK(mst.size() == N - 1);
+  CHECK(sortedWeights(mst) == sortedWeights(expected));
+
+  copy = edges;
+  mst = filterKruskalPool(copy, N);
+  CHECK(mst.size() == N - 1);
+  CHECK(sortedWeights(mst) == sortedWeights(expected));
+}
+
+template <class E>
+static void checkFilterKruskalTyped(float maxw) {
+  Random rnd(37);
+  int N = 2000;
+  std::vector<E> edges;
+  randomGraphOneLong(rnd, N, 100000, maxw, edges);
+  std::vector<E> copy = edges;
+  std::vector<E> expected = kruskal(copy, N);
+
+  std::vector<E> mst = filterKruskal(edges, N);
+  CHECK(mst.size() == N - 1);
+  CHECK(sortedWeights(mst) == sortedWeights(expected));
+}
+
+TEST_CASE("filterKruskal edge types") {
+  CHECK(sizeof(BasicEdge<u16, float>) == 8);
+  checkFilterKruskalTyped<BasicEdge<u16, float>>(1.0);
+  checkFilterKruskalTyped<BasicEdge<u32, double>>(1.0);
+  checkFilterKruskalTyped<BasicEdge<u64, u32>>(1 << 20);
+  checkFilterKruskalTyped<BasicEdge<u32, u64>>(1 << 20);
+
+  // the same graph gives the same MST with wider types
+  Random rnd(37);
+  Edges edges;
+  randomGraphOneLong(rnd, 2000, 100000, 1.0, edges);
+  std::vector<BasicEdge<u64, double>> wide;
+  for (const Edge &e : edges) wide.emplace_back(e.a, e.b, e.w);
+  std::vector<float> narrow = sortedWeights(filterKruskal(edges, 2000));
+  std::vector<double> wideWeights = sortedWeights(filterKruskal(wide, 2000));
+  CHECK(std::equal(narrow.begin(), narrow.end(), wideWeights.begin(),
+                   wideWeights.end()));
+}
@@ -9,6 +9,7 @@
 #include "../utils/base.hpp"
 #include "../utils/graph.hpp"
 #include "../utils/random.hpp"
+#include "../utils/soaedges.hpp"
 #include "kdtree.hpp"
 
 static Pos randomPos(Random &rnd, float s) {
@@ -94,20 +95,28 @@ static void randomGeometricGraphSeq(Random &rnd, int n, i64 m, float maxcoord,
   }
 }
 
-static void randomGraphFull(Random &rnd, int n, float maxw, Edges &edges) {
-  i64 m = (i64)n * (n - 1) / 2;
+// the random graph generators below fill a vector of any edge type or
+// SoaEdges, the weights are drawn as floats and converted to its weight type.
+// the node counts are 64 bit, the ids must fit the node id type of the edges
+
+template <class EdgeList>
+static void randomGraphFull(Random &rnd, i64 n, float maxw, EdgeList &edges) {
+  typedef typename EdgeList::value_type E;
+  i64 m = n * (n - 1) / 2;
   edges.resize(m);
   i64 i = 0;
-  for (int a = 0; a < n; a++) {
-    for (int b = a + 1; b < n; b++) {
+  for (i64 a = 0; a < n; a++) {
+    for (i64 b = a + 1; b < n; b++) {
       float weight = rnd.getFloat() * maxw;
-      edges[i++] = Edge(a, b, weight);
+      setEdge(edges, i++, E(a, b, weight));
     }
   }
 }
 
-static void randomGraphDense(Random &rnd, int n, i64 m, float maxw,
-                             Edges &edges) {
+template <class EdgeList>
+static void randomGraphDense(Random &rnd, i64 n, i64 m, float maxw,
+                             EdgeList &edges) {
+  typedef typename EdgeList::value_type E;
   if (m <= 0) return;
 
   i64 maxm = i64(n) * (i64(n) - 1) / 2;
@@ -117,17 +126,20 @@ static void randomGraphDense(Random &rnd, int n, i64 m, float maxw,
   edges.clear();
   edges.reserve(m * 1.001);
 
-  for (int a = 0; a < n; a++) {
-    for (int b = a + 1; b < n; b++) {
+  for (i64 a = 0; a < n; a++) {
+    for (i64 b = a + 1; b < n; b++) {
       if (rnd.getDouble() < p) {
         float weight = rnd.getFloat() * maxw;
-        edges.emplace_back(Edge(a, b, weight));
+        edges.emplace_back(E(a, b, weight));
       }
     }
   }
 }
 
-static void randomGraph(Random &rnd, int n, i64 m, float maxw, Edges &edges) {
+template <class EdgeList>
+static void randomGraph(Random &rnd, i64 n, i64 m, float maxw,
+                        EdgeList &edges) {
+  typedef typename EdgeList::value_type E;
   i64 maxm = i64(n) * (i64(n) - 1) / 2;
   if (m >= maxm) return randomGraphFull(rnd, n, maxw, edges);
   // if (m > maxm * 0.63) return randomGraphDense(rnd, n, m, maxw, edges);
@@ -137,7 +149,7 @@ static void randomGraph(Random &rnd, int n, i64 m, float maxw, Edges &edges) {
 
   // inverse logarithm of the probability of not picking an edge
   double ilogp = 1.0 / std::log(1.0 - double(m) / double(maxm));
-  int a = 0, b = 0;
+  i64 a = 0, b = 0;
 
   edges.clear();
   edges.reserve(m * 1.001);  // if the number of edges is big, we almost never
@@ -146,35 +158,54 @@ static void randomGraph(Random &rnd, int n, i64 m, float maxw, Edges &edges) {
   while (true) {
     double p0 = rnd.getDouble();
     double logpp = log(p0) * ilogp;
-    int skip = std::max(int(logpp) + 1, int(1));
+    i64 skip = std::max(i64(logpp) + 1, i64(1));
     b += skip;
 
-    while (b >= n) {
+    // past the last row b would never get back under n
+    while (b >= n && a < n - 1) {
       b += ++a - n + 1;
     }
 
     if (a >= n - 1) break;
 
     float weight = rnd.getFloat() * maxw;
-    edges.emplace_back(Edge(a, b, weight));
+    edges.emplace_back(E(a, b, weight));
+  }
+}
+
+// rounds the weights in [0, maxw) down to one of levels distinct values
+template <class EdgeList>
+static void quantizeWeights(EdgeList &edges, float maxw, int levels) {
+  typedef typename EdgeList::value_type E;
+  for (u64 i = 0; i < edges.size(); i++) {
+    E e = edges[i];
+    int level = std::min(int(e.w / maxw * levels), levels - 1);
+    e.w = maxw * level / levels;
+    setEdge(edges, i, e);
   }
 }
 
-static void randomGraphOneLongDense(Random &rnd, int n, i64 m, float maxw,
-                                    Edges &edges) {
+template <class EdgeList>
+static void randomGraphOneLongDense(Random &rnd, i64 n, i64 m, float maxw,
+                                    EdgeList &edges) {
+  typedef typename EdgeList::value_type E;
   randomGraph(rnd, n, m, maxw / 2.f, edges);
-  for (Edge &e : edges) {
+  for (u64 i = 0; i < edges.size(); i++) {
+    E e = edges[i];
     if (e.a != 0) break;
     e.w = maxw;
+    setEdge(edges, i, e);
   }
 }
 
-static void randomGraphOneLong(Random &rnd, int n, i64 m, float maxw,
-                               Edges &edges) {
-  i64 maxm = (i64)n * ((i64)n - 1) / 2;
+template <class EdgeList>
+static void randomGraphOneLong(Random &rnd, i64 n, i64 m, float maxw,
+                               EdgeList &edges) {
+  typedef typename EdgeList::value_type E;
+  i64 maxm = n * (n - 1) / 2;
   // if (m > maxm * 0.63) return randomGraphOneLongDense(rnd, n, m, maxw,
   // edges);
 
   randomGraph(rnd, n - 1, m - 1, maxw / 2.f, edges);
-  edges.push_back(Edge(0, n - 1, maxw));
+  edges.push_back(E(0, n - 1, maxw));
 }
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+
+// kruskal() on buckets with about the same number of edges: a histogram of
+// the weights in a known range [minw, maxw] gives the bucket boundaries in one
+// pass, without sampling. the edges are distributed in place, then every
+// bucket is filtered and sorted in order until the MST is complete. the
+// buckets that are still too big are split again over the range of their
+// bins
+
+// buckets up to this size are sorted by kruskal(), the default base case
+static const u64 HISTOGRAM_BUCKET_SIZE = 4096;
+// buckets of one distribution step, more would thrash the cache
+static const u64 HISTOGRAM_MAX_BUCKETS = 256;
+// histogram bins for each bucket, more bins give more even buckets. the bins
+// of a step must fit the u16 oracle
+static const u64 HISTOGRAM_BINS_PER_BUCKET = 8;
+
+struct WeightHistogram {
+  float minw;
+  float scale;  // bins per unit of weight
+  u64 bins;
+
+  WeightHistogram(float minw, float maxw, u64 bins)
+      : minw(minw), scale(bins / (maxw - minw)), bins(bins) {}
+
+  inline u64 bin(float w) const {
+    double pos = (w - minw) * scale;
+    return pos <= 0 ? 0 : std::min(u64(pos), bins - 1);
+  }
+};
+
+// all the weights in [first, last) must be in [minw, maxw]. as in
+// sampleSortKruskal, buffer and oracle have the size of the edge list and are
+// shared between the recursion levels, the oracle keeps the bin of every edge
+static inline void histogramKruskal(DisjointSet &set, EdgeIt first,
+                                    EdgeIt last, u64 N, Edges &mst,
+                                    float minw, float maxw, EdgeIt buffer,
+                                    u16 *oracle,
+                                    u64 bucketSize = HISTOGRAM_BUCKET_SIZE) {
+  u64 M = last - first;
+  if (M == 0) return;
+  // the bounds of a child come from float arithmetic and can round to the
+  // same value while the weights in the range still differ
+  if (!(minw < maxw)) return kruskal(set, first, last, N, true, mst);
+
+  if (M <= bucketSize) return kruskal(set, first, last, N, true, mst);
+
+  u64 K = std::min((M + bucketSize - 1) / bucketSize, HISTOGRAM_MAX_BUCKETS);
+  WeightHistogram hist(minw, maxw, K * HISTOGRAM_BINS_PER_BUCKET);
+
+  std::vector<u64> binCount(hist.bins, 0);
+  for (u64 i = 0; i < M; i++) {
+    oracle[i] = hist.bin(first[i].w);
+    binCount[oracle[i]]++;
+  }
+
+  // consecutive bins go to the same bucket until it reaches its share of
+  // the edges
+  std::vector<u32> binBucket(hist.bins);
+  std::vector<u64> bucketStart(K + 1, 0);
+  std::vector<u64> bucketBin(K + 1, hist.bins);  // first bin of every bucket
+  u64 bucket = 0, seen = 0;
+  bucketBin[0] = 0;
+  for (u64 i = 0; i < hist.bins; i++) {
+    if (seen >= (bucket + 1) * M / K && bucket + 1 < K) {
+      bucket++;
+      bucketBin[bucket] = i;
+    }
+    binBucket[i] = bucket;
+    seen += binCount[i];
+    bucketStart[bucket + 1] = seen;
+  }
+  K = bucket + 1;
+  bucketStart.resize(K + 1);
+  bucketBin[K] = hist.bins;
+
+  // all the edges in one bucket: the given range is loose, so split again
+  // over the range of the weights. if that is not narrower, the bins can not
+  // split the weights any further
+  for (u64 b = 0; b < K; b++) {
+    if (bucketStart[b + 1] - bucketStart[b] < M) continue;
+    auto range = std::minmax_element(first, last);
+    float lo = range.first->w, hi = range.second->w;
+    if (lo == hi || (lo == minw && hi == maxw)) {
+      return kruskal(set, first, last, N, true, mst);
+    }
+    return histogramKruskal(set, first, last, N, mst, lo, hi, buffer, oracle,
+                            bucketSize);
+  }
+
+  std::vector<u64> writePos(bucketStart.begin(), bucketStart.end() - 1);
+  for (u64 i = 0; i < M; i++) {
+    buffer[writePos[binBucket[oracle[i]]]++] = first[i];
+  }
+  std::copy(buffer, buffer + M, first);
+
+  for (u64 b = 0; b < K; b++) {
+    if (mst.size() == N - 1) return;
+    EdgeIt bucketFirst = first + bucketStart[b];
+    EdgeIt bucketLast = first + bucketStart[b + 1];
+    if (b > 0) bucketLast = filterAll(set, bucketFirst, bucketLast);
+    histogramKruskal(set, bucketFirst, bucketLast, N, mst,
+                     minw + bucketBin[b] / hist.scale,
+                     minw + bucketBin[b + 1] / hist.scale,
+                     buffer + bucketStart[b], oracle + bucketStart[b],
+                     bucketSize);
+  }
+}
+
+static inline Edges histogramKruskal(Edges &edges, u64 N, float minw,
+                                     float maxw,
+                                     u64 bucketSize = HISTOGRAM_BUCKET_SIZE) {
+  DisjointSet set(N);
+  Edges mst;
+  Edges buffer(edges.size());
+  std::vector<u16> oracle(edges.size());
+  histogramKruskal(set, edges.begin(), edges.end(), N, mst, minw, maxw,
+                   buffer.begin(), oracle.data(), bucketSize);
+  return mst;
+}
+
+// the range of the weights is found with an extra pass
+static inline Edges histogramKruskal(Edges &edges, u64 N,
+                                     u64 bucketSize = HISTOGRAM_BUCKET_SIZE) {
+  if (edges.empty()) return Edges();
+  auto range = std::minmax_element(edges.begin(), edges.end());
+  return histogramKruskal(edges, N, range.first->w, range.second->w,
+                          bucketSize);
+}
+
+TEST_CASE("histogramKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return histogramKruskal(edges, N); }, 89);
+
+  // a wider range than the weights
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return histogramKruskal(edges, N, 0.0, 2.0); },
+      89);
+
+  // a range so loose that all the weights land in one bin. the edges are
+  // still split into buckets, so the buckets after the MST are not sorted,
+  // while the fallback would sort the whole list. only equal weights are
+  // sorted by the fallback
+  checkAgainstKruskal(
+      [](Edges &edges, int N) {
+        auto range = std::minmax_element(edges.begin(), edges.end());
+        bool equal = range.first->w == range.second->w;
+        Edges mst = histogramKruskal(edges, N, 0.0, 1e30);
+        CHECK(std::is_sorted(edges.begin(), edges.end()) == equal);
+        return mst;
+      },
+      89);
+}
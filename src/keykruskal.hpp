@@ -0,0 +1,237 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "radixkruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+
+// Filter-Kruskal on 8 byte keys (weight bits << 32 | edge index) instead of
+// the 12 byte edges: the keys compare like the weights, the edge list is never
+// moved and its endpoints are read only by the filter and the union find.
+// the weights must be non negative and there must be less than 2^32 edges
+
+typedef u64 EdgeKey;
+
+static const u64 KEY_BASE_CASE = 1000;
+
+static inline EdgeKey makeKey(const Edge &e, u32 index) {
+  return (u64(weightBits(e.w)) << 32) | index;
+}
+
+static inline u32 keyIndex(EdgeKey key) { return u32(key); }
+
+// the index of an edge must fit the low 32 bits of its key, bigger edge lists
+// abort, also in release builds
+static inline void makeKeys(const Edges &edges, std::vector<EdgeKey> &keys) {
+  if (edges.size() > UINT32_MAX) {
+    std::cerr << "The key engines take less than 2^32 edges" << std::endl;
+    unreachable();
+  }
+  keys.resize(edges.size());
+  for (u64 i = 0; i < edges.size(); i++) keys[i] = makeKey(edges[i], i);
+}
+
+// the key engines take any MST sink of kruskal() (see mstsink.hpp). the edge
+// list is never moved, so the key of an MST edge holds its position in the
+// input and the MST can also be collected as the indices of its edges or as a
+// bitmap over the input. these two sinks take the index from the key, they
+// have no push_back(const Edge &) and do not fit the engines that move edges
+
+struct MstIndices {
+  std::vector<u32> indices;  // the keys hold u32 indices
+
+  inline void push_back(u32 index) { indices.push_back(index); }
+  inline u64 size() const { return indices.size(); }
+};
+
+struct MstBitmap {
+  std::vector<u64> words;
+  u64 count = 0;
+
+  MstBitmap(u64 M) : words((M + 63) / 64) {}
+
+  inline void push_back(u32 index) {
+    words[index / 64] |= u64(1) << (index % 64);
+    count++;
+  }
+  inline u64 size() const { return count; }
+
+  bool test(u64 i) const { return (words[i / 64] >> (i % 64)) & 1; }
+};
+
+template <class Mst>
+static inline void pushKey(const Edges &edges, EdgeKey key, Mst &mst) {
+  mst.push_back(edges[keyIndex(key)]);
+}
+
+static inline void pushKey(const Edges &edges, EdgeKey key, MstIndices &mst) {
+  UNUSED(edges);
+  mst.push_back(keyIndex(key));
+}
+
+static inline void pushKey(const Edges &edges, EdgeKey key, MstBitmap &mst) {
+  UNUSED(edges);
+  mst.push_back(keyIndex(key));
+}
+
+template <class Set, class Mst>
+static inline bool addKeyToMst(Set &set, const Edges &edges, EdgeKey key,
+                               Mst &mst) {
+  const Edge &e = edges[keyIndex(key)];
+  bool canAddEdge = set.checkMerge(e.a, e.b);
+  if (canAddEdge) pushKey(edges, key, mst);
+  return canAddEdge;
+}
+
+// LSD radix sort on the weight bits of the keys, buffer has the same size of
+// the range. the passes where all the keys have the same digit are skipped
+static inline void sortKeys(EdgeKey *first, EdgeKey *last, EdgeKey *buffer) {
+  const int K = RADIX_BUCKETS;
+  u64 M = last - first;
+  EdgeKey *from = first, *to = buffer;
+  for (int shift = 32; shift < 64; shift += RADIX_BITS) {
+    u64 count[K] = {0};
+    for (u64 i = 0; i < M; i++) count[(from[i] >> shift) & (K - 1)]++;
+    if (count[(from[0] >> shift) & (K - 1)] == M) continue;
+
+    u64 pos = 0;
+    for (int b = 0; b < K; b++) {
+      u64 c = count[b];
+      count[b] = pos;
+      pos += c;
+    }
+    for (u64 i = 0; i < M; i++) {
+      to[count[(from[i] >> shift) & (K - 1)]++] = from[i];
+    }
+    std::swap(from, to);
+  }
+  if (from != first) std::copy(from, from + M, first);
+}
+
+// kruskal() on the keys, the edges are read in order of weight
+template <class Mst>
+static inline void keyKruskal(DisjointSet &set, const Edges &edges,
+                              EdgeKey *first, EdgeKey *last, u64 N,
+                              EdgeKey *buffer, Mst &mst) {
+  if (first == last) return;
+  sortKeys(first, last, buffer);
+  for (EdgeKey *it = first; it < last; it++) {
+    if (addKeyToMst(set, edges, *it, mst) && mst.size() == N - 1) break;
+  }
+}
+
+static inline EdgeKey *keyFilterAll(DisjointSet &set, const Edges &edges,
+                                    EdgeKey *first, EdgeKey *last) {
+  while (first < last) {
+    const Edge &e = edges[keyIndex(*first)];
+    if (filter(set, e.a, e.b)) {
+      *first = *(--last);
+    } else {
+      ++first;
+    }
+  }
+  return last;
+}
+
+// buffer is at least as large as the key range and is used by the base cases
+template <class Mst>
+static inline void keyFilterKruskal(DisjointSet &set, const Edges &edges,
+                                    EdgeKey *first, EdgeKey *last, u64 N,
+                                    Mst &mst, EdgeKey *buffer,
+                                    u64 baseCase = KEY_BASE_CASE) {
+  static Random rnd(31);
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return keyKruskal(set, edges, first, last, N, buffer, mst);
+
+  // the keys are all different, so the pivot splits even equal weights
+  std::swap(first[rnd.getULong(M)], first[0]);
+  EdgeKey pivot = *(first++);
+  EdgeKey *mid =
+      std::partition(first, last, [pivot](EdgeKey k) { return k < pivot; });
+
+  keyFilterKruskal(set, edges, first, mid, N, mst, buffer, baseCase);
+
+  if (mst.size() < N - 1) addKeyToMst(set, edges, pivot, mst);
+  if (mst.size() < N - 1) {
+    last = keyFilterAll(set, edges, mid, last);
+    keyFilterKruskal(set, edges, mid, last, N, mst, buffer, baseCase);
+  }
+}
+
+// solves the MST into any sink
+template <class Mst>
+static inline void keyFilterKruskalInto(const Edges &edges, u64 N, Mst &mst,
+                                        u64 baseCase = KEY_BASE_CASE) {
+  DisjointSet set(N);
+  std::vector<EdgeKey> keys, buffer(edges.size());
+  makeKeys(edges, keys);
+  keyFilterKruskal(set, edges, keys.data(), keys.data() + keys.size(), N, mst,
+                   buffer.data(), baseCase);
+}
+
+static inline Edges keyFilterKruskal(const Edges &edges, u64 N,
+                                     u64 baseCase = KEY_BASE_CASE) {
+  Edges mst;
+  if (N > 0) mst.reserve(N - 1);
+  keyFilterKruskalInto(edges, N, mst, baseCase);
+  return mst;
+}
+
+// the positions of the MST edges in edges
+static inline std::vector<u32> keyFilterKruskalIndices(
+    const Edges &edges, u64 N, u64 baseCase = KEY_BASE_CASE) {
+  MstIndices mst;
+  if (N > 0) mst.indices.reserve(N - 1);
+  keyFilterKruskalInto(edges, N, mst, baseCase);
+  return mst.indices;
+}
+
+static inline MstBitmap keyFilterKruskalBitmap(const Edges &edges, u64 N,
+                                               u64 baseCase = KEY_BASE_CASE) {
+  MstBitmap mst(edges.size());
+  keyFilterKruskalInto(edges, N, mst, baseCase);
+  return mst;
+}
+
+TEST_CASE("keyFilterKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return keyFilterKruskal(edges, N); }, 67);
+
+  // the other sinks pick the same edges
+  checkAgainstKruskal(
+      [](Edges &edges, int N) {
+        Edges mst;
+        for (u32 i : keyFilterKruskalIndices(edges, N)) {
+          mst.push_back(edges[i]);
+        }
+        return mst;
+      },
+      67);
+  checkAgainstKruskal(
+      [](Edges &edges, int N) {
+        MstBitmap bitmap = keyFilterKruskalBitmap(edges, N);
+        Edges mst;
+        for (u64 i = 0; i < edges.size(); i++) {
+          if (bitmap.test(i)) mst.push_back(edges[i]);
+        }
+        CHECK(bitmap.count == mst.size());
+        return mst;
+      },
+      67);
+
+  // the empty graph
+  CHECK(keyFilterKruskal(Edges(), 0).empty());
+  CHECK(keyFilterKruskalIndices(Edges(), 0).empty());
+}
@@ -2,11 +2,16 @@
 
 #include <algorithm>
 
+#include "smallsort.hpp"
 #include "unionfind.hpp"
 #include "utils/graph.hpp"
 
+// the MST can be a vector of edges or any sink with push_back() and size(),
+// see mstsink.hpp
+
 // adds the edge e to the MST if it is possible
-static inline bool addEdgeToMst(DisjointSet &set, const Edge &e, Edges &mst) {
+template <class Set, class E, class Mst>
+static inline bool addEdgeToMst(Set &set, const E &e, Mst &mst) {
   bool canAddEdge = set.checkMerge(e.a, e.b);
   if (canAddEdge) {
     mst.push_back(e);
@@ -14,22 +19,23 @@ static inline bool addEdgeToMst(DisjointSet &set, const Edge &e, Edges &mst) {
   return canAddEdge;
 }
 
-static inline void kruskal(DisjointSet &set, EdgeIt first, EdgeIt last, int N,
-                           bool doSort, Edges &mst) {
-  if (doSort) std::sort(first, last);
+template <class Set, class It, class Mst>
+static inline void kruskal(Set &set, It first, It last, u64 N, bool doSort,
+                           Mst &mst) {
+  if (doSort) sortEdges(first, last);
 
   float cost = 0;
-  for (EdgeIt it = first; it < last; it++) {
-    Edge &e = *it;
-    if (addEdgeToMst(set, e, mst) && (mst.size() == N - 1)) {
+  for (It it = first; it < last; it++) {
+    if (addEdgeToMst(set, *it, mst) && (mst.size() == N - 1)) {
       break;
     }
   }
 }
 
-static inline Edges kruskal(Edges &edges, int N) {
-  DisjointSet set(N);
-  Edges mst;
+template <class E>
+static inline std::vector<E> kruskal(std::vector<E> &edges, u64 N) {
+  EdgeDisjointSet<E> set(N);
+  std::vector<E> mst;
   kruskal(set, edges.begin(), edges.end(), N, true, mst);
   return mst;
 }
\ No newline at end of file
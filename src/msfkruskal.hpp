@@ -0,0 +1,108 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "parallelfilterkruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/parallel.hpp"
+
+// minimum spanning forest: on a graph with C connected components the forest
+// has N - C edges, so once they are counted kruskal and filterKruskal can stop
+// as early as they do on connected graphs
+
+// every thread merges the endpoints of a chunk of the edges in one shared
+// union find, every successful merge joins two components
+template <class E>
+static inline u64 countComponents(const std::vector<E> &edges, u64 N,
+                                  int nThreads) {
+  u64 M = edges.size();
+  EdgeConcurrentDisjointSet<E> set(N, nThreads);
+  std::vector<u64> merges(nThreads, 0);
+
+  parallelRun(nThreads, [&](int t) {
+    u64 last = chunkStart(M, nThreads, t + 1);
+    u64 count = 0;
+    for (u64 i = chunkStart(M, nThreads, t); i < last; i++) {
+      count += set.checkMerge(edges[i].a, edges[i].b);
+    }
+    merges[t] = count;
+  });
+
+  u64 components = N;
+  for (u64 m : merges) components -= m;
+  return components;
+}
+
+struct SpanningForest {
+  u64 components = 0;
+  Edges edges;
+  std::vector<Edges> trees;  // one per component, empty for isolated nodes
+};
+
+// splits the forest in the trees of the components, set has the components
+// of the graph
+static inline void splitForest(DisjointSet &set, SpanningForest &forest) {
+  std::vector<u64> component(set.N, forest.components);
+  u64 next = 0;
+  for (u64 x = 0; x < set.N; x++) {
+    u32 root = set.find(x);
+    if (component[root] == forest.components) component[root] = next++;
+  }
+  forest.trees.assign(forest.components, Edges());
+  for (const Edge &e : forest.edges) {
+    forest.trees[component[set.find(e.a)]].push_back(e);
+  }
+}
+
+static inline SpanningForest msfFilterKruskal(
+    Edges &edges, u64 N, int nThreads = hardwareThreads(),
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  SpanningForest forest;
+  if (!useParallel(edges.size(), nThreads)) nThreads = 1;
+  forest.components = countComponents(edges, N, nThreads);
+
+  // the node count only sets when the MST is complete, N - C + 1 nodes
+  // complete it with N - C edges
+  DisjointSet set(N);
+  filterKruskal(set, edges.begin(), edges.end(), N - forest.components + 1,
+                forest.edges, baseCase);
+  splitForest(set, forest);
+  return forest;
+}
+
+TEST_CASE("msfFilterKruskal") {
+  Random rnd(73);
+  int parts = 3, partN = 1000;
+  int N = parts * partN + 10;  // the last 10 nodes are isolated
+  Edges edges;
+  for (int p = 0; p < parts; p++) {
+    Edges part;
+    randomGraphOneLong(rnd, partN, 30000, 1.0, part);
+    for (Edge &e : part) {
+      edges.emplace_back(e.a + p * partN, e.b + p * partN, e.w);
+    }
+  }
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  for (int nThreads : {1, 3}) {
+    CHECK(countComponents(edges, N, nThreads) == parts + 10);
+  }
+
+  copy = edges;
+  SpanningForest forest = msfFilterKruskal(copy, N, 2);
+  CHECK(forest.components == parts + 10);
+  CHECK(forest.edges.size() == N - forest.components);
+  CHECK(sortedWeights(forest.edges) == sortedWeights(expected));
+  REQUIRE(forest.trees.size() == forest.components);
+  for (int p = 0; p < parts; p++) CHECK(forest.trees[p].size() == partN - 1);
+  for (u64 c = parts; c < forest.components; c++) {
+    CHECK(forest.trees[c].empty());
+  }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "keykruskal.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+
+// MST sinks: kruskal(), filterKruskal() and the key engines push every edge
+// to the MST as soon as it is accepted, and stop when mst.size() reaches
+// N - 1, so any type with push_back(const E &) and size() can be the MST.
+// a sink that forwards the edge instead of storing it lets the consumer
+// start on the first edges while the rest of the MST is still being computed.
+// the edges are emitted in order of weight
+
+// calls fn(e) for every MST edge
+template <class E, class F>
+struct CallbackMst {
+  F fn;
+  u64 count = 0;
+
+  CallbackMst(F fn) : fn(fn) {}
+
+  inline void push_back(const E &e) {
+    fn(e);
+    count++;
+  }
+
+  inline u64 size() const { return count; }
+};
+
+// bounded single producer single consumer queue, push() waits while the queue
+// is full and pop() waits while it is empty
+template <class T>
+struct SpscQueue {
+  std::vector<T> slots;
+  alignas(64) std::atomic<u64> head;  // next slot to read
+  alignas(64) std::atomic<u64> tail;  // next slot to write
+  std::atomic<bool> closed;
+
+  SpscQueue(u64 capacity)
+      : slots(std::max(capacity, (u64)1)), head(0), tail(0), closed(false) {}
+
+  void push(const T &x) {
+    u64 t = tail.load(std::memory_order_relaxed);
+    while (t - head.load(std::memory_order_acquire) == slots.size()) {
+      std::this_thread::yield();
+    }
+    slots[t % slots.size()] = x;
+    tail.store(t + 1, std::memory_order_release);
+  }
+
+  // false when the queue is closed and there is nothing left to read
+  bool pop(T &x) {
+    u64 h = head.load(std::memory_order_relaxed);
+    while (h == tail.load(std::memory_order_acquire)) {
+      // the last push happens before close, so check again after it
+      if (closed.load(std::memory_order_acquire) &&
+          h == tail.load(std::memory_order_acquire)) {
+        return false;
+      }
+      std::this_thread::yield();
+    }
+    x = slots[h % slots.size()];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // called by the producer after the last push
+  void close() { closed.store(true, std::memory_order_release); }
+};
+
+// pushes every MST edge to a queue
+template <class E>
+struct QueueMst {
+  SpscQueue<E> &queue;
+  u64 count = 0;
+
+  QueueMst(SpscQueue<E> &queue) : queue(queue) {}
+
+  inline void push_back(const E &e) {
+    queue.push(e);
+    count++;
+  }
+
+  inline u64 size() const { return count; }
+};
+
+// the wrappers return the number of MST edges
+
+template <class E, class F>
+static inline u64 kruskalCallback(std::vector<E> &edges, u64 N, F fn) {
+  EdgeDisjointSet<E> set(N);
+  CallbackMst<E, F> mst(fn);
+  kruskal(set, edges.begin(), edges.end(), N, true, mst);
+  return mst.size();
+}
+
+template <class E, class F>
+static inline u64 filterKruskalCallback(
+    std::vector<E> &edges, u64 N, F fn,
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  EdgeDisjointSet<E> set(N);
+  CallbackMst<E, F> mst(fn);
+  filterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst.size();
+}
+
+// the queue is closed at the end, so the consumer can pop until pop() fails
+template <class E>
+static inline u64 filterKruskalToQueue(
+    std::vector<E> &edges, u64 N, SpscQueue<E> &queue,
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  EdgeDisjointSet<E> set(N);
+  QueueMst<E> mst(queue);
+  filterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  queue.close();
+  return mst.size();
+}
+
+TEST_CASE("MST sinks") {
+  Random rnd(103);
+  int N = 2000;
+  Edges edges;
+  randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  Edges emitted;
+  auto collect = [&](const Edge &e) { emitted.push_back(e); };
+  copy = edges;
+  CHECK(kruskalCallback(copy, N, collect) == N - 1);
+  CHECK(sortedWeights(emitted) == sortedWeights(expected));
+
+  emitted.clear();
+  copy = edges;
+  CHECK(filterKruskalCallback(copy, N, collect) == N - 1);
+  CHECK(std::is_sorted(emitted.begin(), emitted.end()));
+  CHECK(sortedWeights(emitted) == sortedWeights(expected));
+
+  // the key engines take the same sinks
+  emitted.clear();
+  CallbackMst<Edge, decltype(collect)> sink(collect);
+  keyFilterKruskalInto(edges, N, sink);
+  CHECK(sink.size() == N - 1);
+  CHECK(sortedWeights(emitted) == sortedWeights(expected));
+
+  // a small queue, so the producer has to wait for the consumer
+  SpscQueue<Edge> queue(64);
+  Edges consumed;
+  std::thread consumer([&] {
+    Edge e;
+    while (queue.pop(e)) consumed.push_back(e);
+  });
+  copy = edges;
+  u64 produced = filterKruskalToQueue(copy, N, queue);
+  consumer.join();
+  CHECK(produced == N - 1);
+  CHECK(std::is_sorted(consumed.begin(), consumed.end()));
+  CHECK(sortedWeights(consumed) == sortedWeights(expected));
+}
@@ -153,6 +153,9 @@ struct BestPivotFinder {
   }
 };
 
+// ranges with fewer edges than the base case are solved by kruskal()
+static const u64 SEEDED_BASE_CASE = 100;
+
 static inline std::vector<Edge> findBestPivots(const Edges &edges, int N) {
   BestPivotFinder finder(edges, N);
   auto pivots = finder.getBestPivots();
@@ -161,31 +164,34 @@ static inline std::vector<Edge> findBestPivots(const Edges &edges, int N) {
 
 static inline void filterKruskalSeeded(DisjointSet &set, Edges &edges,
                                        int first, int last, int N, Edges &mst,
-                                       EdgeIt &nextPivot) {
+                                       EdgeIt &nextPivot,
+                                       u64 baseCase = SEEDED_BASE_CASE) {
   u64 M = last - first;
   if (M == 0) return;
-  if (M < 100)
+  if (M < baseCase)
     return kruskal(set, edges.begin() + first, edges.begin() + last, N, true,
                    mst);
 
   Edge pivot = *nextPivot++;
   int mid = partitionSkipPivot(edges, first, last, pivot);
 
-  filterKruskalSeeded(set, edges, first, mid, N, mst, nextPivot);
+  filterKruskalSeeded(set, edges, first, mid, N, mst, nextPivot, baseCase);
 
   if (mst.size() < N - 1) addEdgeToMst(set, pivot, mst);
   if (mst.size() < N - 1) {
     last = filterAll(set, edges.begin() + mid, edges.begin() + last) -
            edges.begin();
-    filterKruskalSeeded(set, edges, mid, last, N, mst, nextPivot);
+    filterKruskalSeeded(set, edges, mid, last, N, mst, nextPivot, baseCase);
   }
 }
 
-static inline Edges filterKruskalSeeded(Edges &edges, int N, Edges &pivots) {
+static inline Edges filterKruskalSeeded(Edges &edges, int N, Edges &pivots,
+                                        u64 baseCase = SEEDED_BASE_CASE) {
   // ciao
   DisjointSet set(N);
   EdgeIt nextPivot = pivots.begin();
   Edges mst;
-  filterKruskalSeeded(set, edges, 0, edges.size(), N, mst, nextPivot);
+  filterKruskalSeeded(set, edges, 0, edges.size(), N, mst, nextPivot,
+                      baseCase);
   return mst;
 }
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <doctest.h>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "parallelpartition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/parallel.hpp"
+
+// below this many edges per thread the sequential procedures are faster
+static const u64 PARALLEL_MIN_EDGES_PER_THREAD = 1 << 16;
+
+static inline bool useParallel(u64 M, int nThreads) {
+  return nThreads > 1 && M >= PARALLEL_MIN_EDGES_PER_THREAD * nThreads;
+}
+
+static inline EdgeIt parallelPartition(EdgeIt first, EdgeIt last,
+                                       float pivotVal, int nThreads) {
+  return parallelPartition(
+      first, last, [pivotVal](const Edge &e) { return e.w < pivotVal; },
+      nThreads);
+}
+
+// same as filterAll, the union find is only read so no set can be merged
+// while the filter is running
+static inline EdgeIt parallelFilterAll(const DisjointSet &set, EdgeIt first,
+                                       EdgeIt last, int nThreads) {
+  return parallelPartition(
+      first, last,
+      [&set](const Edge &e) { return !set.compareConst(e.a, e.b); }, nThreads);
+}
+
+// same as filterAll but checks the edges against a flattened snapshot of the
+// union find, that has to be refreshed before the call
+static inline EdgeIt parallelFilterAll(const FrozenDisjointSet &frozen,
+                                       EdgeIt first, EdgeIt last,
+                                       int nThreads) {
+  return parallelPartition(
+      first, last,
+      [&frozen](const Edge &e) { return !frozen.compare(e.a, e.b); },
+      nThreads);
+}
+
+// filters [first, last) using the fastest available method: flattening the
+// union find costs O(N), so it is only done when there are more edges than
+// nodes to check
+static inline EdgeIt parallelFilterAll(DisjointSet &set,
+                                       FrozenDisjointSet &frozen, EdgeIt first,
+                                       EdgeIt last, int nThreads) {
+  u64 M = last - first;
+  if (!useParallel(M, nThreads)) return filterAll(set, first, last);
+  if (M < set.N) return parallelFilterAll(set, first, last, nThreads);
+  frozen.refresh(set, nThreads);
+  return parallelFilterAll(frozen, first, last, nThreads);
+}
+
+// filterKruskal where the partition and filter passes of the big recursion
+// levels are split between nThreads threads. the edges are still added to
+// the MST from left to right by the calling thread
+static inline void parallelFilterKruskal(DisjointSet &set,
+                                         FrozenDisjointSet &frozen,
+                                         EdgeIt first, EdgeIt last, int N,
+                                         Edges &mst, int nThreads,
+                                         u64 baseCase =
+                                             FILTER_KRUSKAL_BASE_CASE) {
+  u64 M = last - first;
+  if (!useParallel(M, nThreads)) {
+    return filterKruskal(set, first, last, N, mst, baseCase);
+  }
+
+  EdgeIt pivotPos = pickRandomPivot(first, last);
+  EdgeIt mid = parallelPartition(first, last, pivotPos->w, nThreads);
+
+  parallelFilterKruskal(set, frozen, first, mid, N, mst, nThreads, baseCase);
+
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos, mst);
+  if (mst.size() < N - 1) {
+    last = parallelFilterAll(set, frozen, mid, last, nThreads);
+    parallelFilterKruskal(set, frozen, mid, last, N, mst, nThreads, baseCase);
+  }
+}
+
+static inline Edges parallelFilterKruskal(
+    Edges &edges, int N, int nThreads = hardwareThreads(),
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  FrozenDisjointSet frozen(N);
+  Edges mst;
+  parallelFilterKruskal(set, frozen, edges.begin(), edges.end(), N, mst,
+                        nThreads, baseCase);
+  return mst;
+}
+
+TEST_CASE("parallelFilterKruskal") {
+  Random rnd(11);
+  int N = 5000;
+  Edges edges;
+  randomGraph(rnd, N, 300000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  for (int nThreads : {1, 2, 4}) {
+    copy = edges;
+    Edges mst = parallelFilterKruskal(copy, N, nThreads);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(expected));
+  }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/base.hpp"
+#include "utils/parallel.hpp"
+#include "utils/random.hpp"
+
+// a range [begin, end) of positions, relative to the start of the partitioned
+// list
+struct Span {
+  u64 begin, end;
+};
+
+// walks the positions of a list of spans, starting from the k-th position
+struct SpanCursor {
+  const std::vector<Span> &spans;
+  size_t i;
+  u64 pos;
+
+  // prefix[i] is the total length of the spans before spans[i]
+  SpanCursor(const std::vector<Span> &spans, const std::vector<u64> &prefix,
+             u64 k)
+      : spans(spans) {
+    i = std::upper_bound(prefix.begin(), prefix.end(), k) - prefix.begin() - 1;
+    pos = spans[i].begin + (k - prefix[i]);
+  }
+
+  u64 next() {
+    u64 current = pos++;
+    if (pos == spans[i].end && i + 1 < spans.size()) pos = spans[++i].begin;
+    return current;
+  }
+};
+
+static inline std::vector<u64> spanPrefix(const std::vector<Span> &spans) {
+  std::vector<u64> prefix(spans.size());
+  u64 sum = 0;
+  for (size_t i = 0; i < spans.size(); i++) {
+    prefix[i] = sum;
+    sum += spans[i].end - spans[i].begin;
+  }
+  return prefix;
+}
+
+// every chunk c = [starts[c], starts[c + 1]) is already partitioned around
+// mids[c], and L is the total size of the left sides.
+// swaps the right elements that lie in [0, L) with the left elements that lie
+// in [L, n), the work is split evenly between the threads
+template <class It>
+static inline void swapMisplaced(It first, const std::vector<u64> &starts,
+                                 const std::vector<u64> &mids, u64 L,
+                                 int nThreads) {
+  int nChunks = mids.size();
+  u64 n = starts[nChunks];
+
+  std::vector<Span> rightInLeft, leftInRight;
+  for (int c = 0; c < nChunks; c++) {
+    u64 rb = mids[c], re = std::min(starts[c + 1], L);
+    if (rb < re) rightInLeft.push_back({rb, re});
+    u64 lb = std::max(starts[c], L), le = std::min(mids[c], n);
+    if (lb < le) leftInRight.push_back({lb, le});
+  }
+  if (rightInLeft.empty()) return;
+
+  std::vector<u64> leftPrefix = spanPrefix(rightInLeft);
+  std::vector<u64> rightPrefix = spanPrefix(leftInRight);
+  const Span &lastSpan = rightInLeft.back();
+  u64 K = leftPrefix.back() + (lastSpan.end - lastSpan.begin);
+
+  parallelRun(nThreads, [&](int t) {
+    u64 k = chunkStart(K, nThreads, t);
+    u64 kEnd = chunkStart(K, nThreads, t + 1);
+    if (k == kEnd) return;
+    SpanCursor l(rightInLeft, leftPrefix, k);
+    SpanCursor r(leftInRight, rightPrefix, k);
+    for (; k < kEnd; k++) std::iter_swap(first + l.next(), first + r.next());
+  });
+}
+
+// partitions [first, last) so that the elements that satisfy pred come first.
+// every thread partitions its own chunk, then the elements that ended up on
+// the wrong side of the global split point are swapped in parallel.
+// pred is called concurrently and must not modify shared state
+template <class It, class Pred>
+static inline It parallelPartition(It first, It last, Pred pred,
+                                   int nThreads) {
+  u64 n = last - first;
+  if (nThreads <= 1) return std::partition(first, last, pred);
+
+  std::vector<u64> starts(nThreads + 1), mids(nThreads);
+  for (int t = 0; t <= nThreads; t++) starts[t] = chunkStart(n, nThreads, t);
+
+  parallelRun(nThreads, [&](int t) {
+    It chunkFirst = first + starts[t];
+    It chunkLast = first + starts[t + 1];
+    mids[t] = std::partition(chunkFirst, chunkLast, pred) - first;
+  });
+
+  u64 L = 0;
+  for (int t = 0; t < nThreads; t++) L += mids[t] - starts[t];
+
+  swapMisplaced(first, starts, mids, L, nThreads);
+  return first + L;
+}
+
+TEST_CASE("parallelPartition") {
+  Random rnd(7);
+  for (int nThreads : {1, 2, 3, 8}) {
+    for (int n : {0, 1, 10, 1000}) {
+      std::vector<int> v(n);
+      for (int &x : v) x = rnd.getInt(100);
+      std::vector<int> sorted = v;
+      std::sort(sorted.begin(), sorted.end());
+
+      auto isSmall = [](int x) { return x < 30; };
+      auto mid = parallelPartition(v.begin(), v.end(), isSmall, nThreads);
+      CHECK(std::all_of(v.begin(), mid, isSmall));
+      CHECK(std::none_of(mid, v.end(), isSmall));
+
+      std::sort(v.begin(), v.end());
+      CHECK(v == sorted);
+    }
+  }
+}
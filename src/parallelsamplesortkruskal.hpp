@@ -0,0 +1,346 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "parallelfilterkruskal.hpp"
+#include "parallelpartition.hpp"
+#include "samplesortkruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/parallel.hpp"
+
+// Filter-Kruskal on top of a parallel in-place samplesort partitioner, in the
+// style of IPS4o (Axtmann, Witt, Ferizovic, Sanders).
+//
+// one partitioning step works on blocks of PSS_BLOCK edges:
+// 1. every thread classifies its own stripe, collecting the edges in one
+//    buffer block per bucket, and writes the full buffer blocks back to the
+//    start of its stripe
+// 2. the full blocks of all the stripes are moved to the start of the list
+// 3. the blocks are permuted so that every bucket gets its own blocks, the
+//    threads claim the blocks with atomic read/write pointers
+// 4. the edges left in the buffers fill the gaps at the bucket borders
+
+static const u64 PSS_BLOCK = 128;
+
+static inline u64 alignBlock(u64 x) {
+  return (x + PSS_BLOCK - 1) / PSS_BLOCK * PSS_BLOCK;
+}
+
+// read and write pointers of the blocks of one bucket, measured in blocks from
+// the start of the bucket and packed in one word so that they can be updated
+// together. the blocks in [write, read) have not been processed yet
+struct BucketPointers {
+  std::atomic<u64> pointers;
+  std::atomic<int> reading;  // threads that are copying a block out
+  u32 initialRead;
+
+  void init(u32 read) {
+    pointers = read;
+    reading = 0;
+    initialRead = read;
+  }
+
+  // claims the last unprocessed block, returns false if there is none
+  bool popRead(u32 &slot) {
+    u64 cur = pointers.load();
+    while (true) {
+      u32 write = cur >> 32, read = u32(cur);
+      if (write >= read) return false;
+      if (pointers.compare_exchange_weak(cur, cur - 1)) {
+        slot = read - 1;
+        return true;
+      }
+    }
+  }
+
+  // claims the next slot where a block of this bucket has to go, returns true
+  // if the slot still holds an unprocessed block
+  bool pushWrite(u32 &slot) {
+    u64 old = pointers.fetch_add(u64(1) << 32);
+    slot = old >> 32;
+    return slot < u32(old);
+  }
+
+  u32 written() { return pointers.load() >> 32; }
+};
+
+struct ParallelSampleSortStep {
+  static const int K = SAMPLESORT_BUCKETS;
+
+  EdgeIt first;
+  u64 M;
+  int nThreads;
+  SampleSortClassifier classifier;
+
+  std::vector<u64> stripeStart, stripeFull;  // per thread
+  std::vector<Edges> buffers;                // K blocks per thread
+  std::vector<std::vector<u64>> count;       // edges per thread and bucket
+  std::vector<std::vector<u64>> buffered;    // buffered per thread and bucket
+
+  std::vector<u64> bucketStart;       // final position of the buckets
+  std::vector<u64> bucketBlockStart;  // bucketStart aligned to the blocks
+  std::vector<BucketPointers> pointers;
+
+  Edges overflow;  // the block that would go past the end of the list
+  std::atomic<int> overflowBucket;
+
+  ParallelSampleSortStep(EdgeIt first, EdgeIt last, int nThreads)
+      : first(first),
+        M(last - first),
+        nThreads(nThreads),
+        stripeStart(nThreads + 1),
+        stripeFull(nThreads),
+        buffers(nThreads),
+        count(nThreads, std::vector<u64>(K)),
+        buffered(nThreads, std::vector<u64>(K)),
+        bucketStart(K + 1),
+        bucketBlockStart(K + 1),
+        pointers(K),
+        overflow(PSS_BLOCK),
+        overflowBucket(-1) {
+    for (int t = 0; t < nThreads; t++) {
+      stripeStart[t] = chunkStart(M, nThreads, t) / PSS_BLOCK * PSS_BLOCK;
+    }
+    stripeStart[nThreads] = M;
+  }
+
+  // partitions the edges in K buckets, returns false if all the edges ended
+  // up in the same bucket
+  bool run() {
+    classifier.build(pickSplitters(first, first + M));
+
+    parallelRun(nThreads, [&](int t) { classifyStripe(t); });
+
+    u64 sum = 0;
+    for (int b = 0; b < K; b++) {
+      bucketStart[b] = sum;
+      for (int t = 0; t < nThreads; t++) sum += count[t][b];
+      if (sum - bucketStart[b] == M) return false;
+    }
+    bucketStart[K] = M;
+    for (int b = 0; b <= K; b++) {
+      bucketBlockStart[b] = alignBlock(bucketStart[b]);
+    }
+
+    u64 fullEnd = 0;
+    for (int t = 0; t < nThreads; t++) {
+      fullEnd += stripeFull[t] - stripeStart[t];
+    }
+    swapMisplaced(first, stripeStart, stripeFull, fullEnd, nThreads);
+
+    for (int b = 0; b < K; b++) {
+      u64 begin = bucketBlockStart[b];
+      u64 end = std::min(bucketBlockStart[b + 1], fullEnd);
+      pointers[b].init(begin < end ? (end - begin) / PSS_BLOCK : 0);
+    }
+    parallelRun(nThreads, [&](int t) { permuteBlocks(t); });
+
+    std::vector<Edges> spill(K);
+    parallelRun(nThreads, [&](int t) {
+      for (int b = K * t / nThreads; b < K * (t + 1) / nThreads; b++) {
+        saveSpill(b, spill[b]);
+      }
+    });
+    parallelRun(nThreads, [&](int t) {
+      for (int b = K * t / nThreads; b < K * (t + 1) / nThreads; b++) {
+        fillBucket(b, spill[b]);
+      }
+    });
+    return true;
+  }
+
+  void classifyStripe(int t) {
+    Edges &buffer = buffers[t];
+    buffer.resize(K * PSS_BLOCK);
+    std::vector<u64> &c = count[t];
+    std::vector<u64> &n = buffered[t];
+
+    // at most as many edges as the ones already read get written back, so
+    // the writes never overtake the reads
+    u64 write = stripeStart[t];
+    for (u64 i = stripeStart[t]; i < stripeStart[t + 1]; i++) {
+      const Edge &e = first[i];
+      int b = classifier.classify(e.w);
+      c[b]++;
+      buffer[b * PSS_BLOCK + n[b]++] = e;
+      if (n[b] == PSS_BLOCK) {
+        EdgeIt block = buffer.begin() + b * PSS_BLOCK;
+        std::copy(block, block + PSS_BLOCK, first + write);
+        write += PSS_BLOCK;
+        n[b] = 0;
+      }
+    }
+    stripeFull[t] = write;
+  }
+
+  void permuteBlocks(int t) {
+    Edges block(PSS_BLOCK), swapBlock(PSS_BLOCK);
+    int primary = K * t / nThreads;
+    for (int i = 0; i < K; i++) {
+      int b = (primary + i) % K;
+      BucketPointers &src = pointers[b];
+      while (true) {
+        u32 slot;
+        src.reading++;
+        bool found = src.popRead(slot);
+        if (found) {
+          EdgeIt pos = first + bucketBlockStart[b] + u64(slot) * PSS_BLOCK;
+          std::copy(pos, pos + PSS_BLOCK, block.begin());
+        }
+        src.reading--;
+        if (!found) break;
+
+        // every block contains edges of a single bucket, move it to its
+        // bucket until a free slot is found
+        while (true) {
+          int dest = classifier.classify(block[0].w);
+          BucketPointers &dst = pointers[dest];
+          bool occupied = dst.pushWrite(slot);
+          u64 pos = bucketBlockStart[dest] + u64(slot) * PSS_BLOCK;
+          if (occupied) {
+            std::copy(first + pos, first + pos + PSS_BLOCK, swapBlock.begin());
+            std::copy(block.begin(), block.end(), first + pos);
+            std::swap(block, swapBlock);
+          } else if (pos + PSS_BLOCK > M) {
+            std::copy(block.begin(), block.end(), overflow.begin());
+            overflowBucket = dest;
+            break;
+          } else {
+            // the slot was just read by another thread, wait for the copy
+            if (slot < dst.initialRead) {
+              while (dst.reading.load() != 0) std::this_thread::yield();
+            }
+            std::copy(block.begin(), block.end(), first + pos);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // end of the blocks of bucket b that are in the list
+  u64 writtenEnd(int b) {
+    u64 end = bucketBlockStart[b] + u64(pointers[b].written()) * PSS_BLOCK;
+    if (b == overflowBucket) end -= PSS_BLOCK;
+    return end;
+  }
+
+  // the last block of bucket b can end past the start of the next bucket,
+  // these edges are saved before the next bucket overwrites them
+  void saveSpill(int b, Edges &spill) {
+    u64 begin = std::max(bucketStart[b + 1], bucketBlockStart[b]);
+    u64 end = writtenEnd(b);
+    if (begin < end) spill.assign(first + begin, first + end);
+  }
+
+  // the positions of bucket b that are not covered by its blocks are
+  // [bucketStart[b], holeEnd) and [holeStart, bucketStart[b + 1]), they are
+  // filled with the buffered edges, the spill and the overflow block
+  void fillBucket(int b, const Edges &spill) {
+    u64 holeEnd = std::min(bucketBlockStart[b], bucketStart[b + 1]);
+    u64 holeStart = std::min(writtenEnd(b), bucketStart[b + 1]);
+    u64 pos = bucketStart[b];
+
+    auto put = [&](const Edge *from, u64 n) {
+      for (u64 i = 0; i < n; i++) {
+        if (pos == holeEnd) pos = holeStart;
+        first[pos++] = from[i];
+      }
+    };
+    for (int t = 0; t < nThreads; t++) {
+      put(&buffers[t][b * PSS_BLOCK], buffered[t][b]);
+    }
+    put(spill.data(), spill.size());
+    if (b == overflowBucket) put(overflow.data(), PSS_BLOCK);
+  }
+};
+
+static inline void parallelSampleSortKruskal(DisjointSet &set,
+                                             FrozenDisjointSet &frozen,
+                                             EdgeIt first, EdgeIt last, int N,
+                                             Edges &mst, int nThreads,
+                                             u64 baseCase =
+                                                 FILTER_KRUSKAL_BASE_CASE) {
+  const int K = SAMPLESORT_BUCKETS;
+  u64 M = last - first;
+  if (!useParallel(M, nThreads)) {
+    return filterKruskal(set, first, last, N, mst, baseCase);
+  }
+
+  std::vector<u64> bucketStart;
+  {
+    ParallelSampleSortStep step(first, last, nThreads);
+    if (!step.run()) return kruskal(set, first, last, N, true, mst);
+    bucketStart = std::move(step.bucketStart);
+  }
+
+  // the MST prefix before bucket b is final once the previous buckets are
+  // done, so the bucket can be filtered by all the threads
+  for (int b = 0; b < K; b++) {
+    if (mst.size() == N - 1) return;
+    EdgeIt bucketFirst = first + bucketStart[b];
+    EdgeIt bucketLast = first + bucketStart[b + 1];
+    if (b > 0) {
+      bucketLast =
+          parallelFilterAll(set, frozen, bucketFirst, bucketLast, nThreads);
+    }
+    parallelSampleSortKruskal(set, frozen, bucketFirst, bucketLast, N, mst,
+                              nThreads, baseCase);
+  }
+}
+
+static inline Edges parallelSampleSortKruskal(
+    Edges &edges, int N, int nThreads = hardwareThreads(),
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  FrozenDisjointSet frozen(N);
+  Edges mst;
+  parallelSampleSortKruskal(set, frozen, edges.begin(), edges.end(), N, mst,
+                            nThreads, baseCase);
+  return mst;
+}
+
+TEST_CASE("ParallelSampleSortStep") {
+  Random rnd(3);
+  Edges edges;
+  randomGraph(rnd, 3000, 300000, 1.0, edges);
+  // few distinct weights, so that the buckets have uneven sizes
+  for (Edge &e : edges) e.w = std::floor(e.w * 10);
+  std::vector<float> expected = sortedWeights(edges);
+
+  ParallelSampleSortStep step(edges.begin(), edges.end(), 4);
+  REQUIRE(step.run());
+  u64 misplaced = 0;
+  for (int b = 0; b < SAMPLESORT_BUCKETS; b++) {
+    for (u64 i = step.bucketStart[b]; i < step.bucketStart[b + 1]; i++) {
+      misplaced += step.classifier.classify(edges[i].w) != b;
+    }
+  }
+  CHECK(misplaced == 0);
+  CHECK(sortedWeights(edges) == expected);
+}
+
+TEST_CASE("parallelSampleSortKruskal") {
+  Random rnd(13);
+  int N = 5000;
+  Edges edges;
+  randomGraphOneLong(rnd, N, 300000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  for (int nThreads : {1, 4}) {
+    copy = edges;
+    Edges mst = parallelSampleSortKruskal(copy, N, nThreads);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(expected));
+  }
+}
@@ -1,12 +1,61 @@
 #pragma once
 
 #include <algorithm>
+#include <utility>
 
 #include "utils/graph.hpp"
 
-static inline EdgeIt partition(EdgeIt first, EdgeIt last, float pivotVal) {
+// moves the edges lighter than pivotVal to the front, for any edge type
+template <class It, class Weight>
+static inline It partitionLess(It first, It last, Weight pivotVal) {
   return std::partition(first, last,
-                        [pivotVal](const Edge &e) { return e.w < pivotVal; });
+                        [pivotVal](const auto &e) { return e.w < pivotVal; });
+}
+
+static inline EdgeIt partition(EdgeIt first, EdgeIt last, float pivotVal) {
+  return partitionLess(first, last, pivotVal);
+}
+
+// three way partition (Dijkstra), the edges with the same weight of the pivot
+// are grouped together:
+//   [first, lt): w < pivotVal
+//   [lt, gt): w == pivotVal
+//   [gt, last): pivotVal < w
+static inline std::pair<EdgeIt, EdgeIt> partitionFat(EdgeIt first, EdgeIt last,
+                                                     float pivotVal) {
+  EdgeIt lt = first, it = first, gt = last;
+  while (it < gt) {
+    if (it->w < pivotVal) {
+      std::iter_swap(it++, lt++);
+    } else if (pivotVal < it->w) {
+      std::iter_swap(it, --gt);
+    } else {
+      ++it;
+    }
+  }
+  return {lt, gt};
+}
+
+// dual pivot partition (Yaroslavskiy), with pivotVal1 <= pivotVal2 the range
+// is split in three parts:
+//   [first, lt): w < pivotVal1
+//   [lt, gt): pivotVal1 <= w < pivotVal2
+//   [gt, last): pivotVal2 <= w
+static inline std::pair<EdgeIt, EdgeIt> partitionDual(EdgeIt first,
+                                                      EdgeIt last,
+                                                      float pivotVal1,
+                                                      float pivotVal2) {
+  EdgeIt lt = first, gt = last;
+  for (EdgeIt it = first; it < gt; ++it) {
+    if (it->w < pivotVal1) {
+      std::iter_swap(it, lt++);
+    } else if (it->w >= pivotVal2) {
+      while (it < gt - 1 && (gt - 1)->w >= pivotVal2) --gt;
+      std::iter_swap(it, --gt);
+      if (it->w < pivotVal1) std::iter_swap(it, lt++);
+    }
+  }
+  return {lt, gt};
 }
 
 // partitions the range [first, last) and filters out the pivot from the list
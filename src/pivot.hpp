@@ -3,15 +3,17 @@
 #include <math.h>
 
 #include <algorithm>
+#include <vector>
 
 #include "utils/graph.hpp"
 #include "utils/random.hpp"
 
 // picks the pivot randomply from the edge list and moves it to the start of the
 // list
-static inline EdgeIt pickRandomPivot(EdgeIt &first, EdgeIt &last) {
+template <class It>
+static inline It pickRandomPivot(It &first, It &last) {
   static Random rnd(31);
-  EdgeIt pivotPos = first + rnd.getULong(last - first);
+  It pivotPos = first + rnd.getULong(last - first);
   std::swap(*pivotPos, *first);
   return first++;
 }
@@ -30,4 +32,33 @@ static inline EdgeIt pickRandomSampleRootK(EdgeIt &first, EdgeIt &last) {
 
   std::sort(firstSample, first);
   return firstSample;
-}
\ No newline at end of file
+}
+
+// sorted sample of sqrt(M) weights taken once at the top of the recursion,
+// every recursion level takes its pivot from the part of the sample that falls
+// in its range of weights, so that the sampling cost is paid only once
+struct PivotPool {
+  std::vector<float> weights;
+
+  PivotPool(EdgeIt first, EdgeIt last) {
+    // the samples are moved to the start of the list, but they stay in it
+    EdgeIt rest = first;
+    EdgeIt samples = pickRandomSampleRootK(rest, last);
+    for (EdgeIt it = samples; it < rest; it++) weights.push_back(it->w);
+  }
+};
+
+// estimates the weight with rank q * (last - first) from a sorted sample of
+// sqrt(last - first) weights, the edge list is not modified
+static inline float pickSampleQuantile(EdgeIt first, EdgeIt last, double q) {
+  static Random rnd(31);
+  u64 M = last - first;
+  u64 nSamples = std::max(u64(std::sqrt(M)), u64(1));
+
+  std::vector<float> samples(nSamples);
+  for (float &w : samples) w = first[rnd.getULong(M)].w;
+
+  u64 rank = std::min(u64(q * nSamples), nSamples - 1);
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  return samples[rank];
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+
+// kruskal() and filterAll with software pipelining: with a big union find
+// every checkMerge waits for two random loads, so the parents of the edges
+// distance positions ahead are prefetched, and the parents of their parents
+// distance / 2 positions ahead, when the first loads have arrived.
+// distance 0 disables the prefetching
+
+static const int PREFETCH_DISTANCE = 16;
+
+static inline void prefetchNodes(const DisjointSet &set, const Edge &e) {
+  set.prefetch(e.a);
+  set.prefetch(e.b);
+}
+
+static inline void prefetchParents(const DisjointSet &set, const Edge &e) {
+  set.prefetchParent(e.a);
+  set.prefetchParent(e.b);
+}
+
+// prefetches for the edges after it
+static inline void prefetchAhead(const DisjointSet &set, EdgeIt it,
+                                 EdgeIt last, int distance) {
+  if (distance <= 0) return;
+  if (last - it > distance) prefetchNodes(set, it[distance]);
+  if (last - it > distance / 2) prefetchParents(set, it[distance / 2]);
+}
+
+// prefetches for the edges before last
+static inline void prefetchBehind(const DisjointSet &set, EdgeIt first,
+                                  EdgeIt last, int distance) {
+  if (distance <= 0) return;
+  if (last - first > distance) prefetchNodes(set, last[-1 - distance]);
+  if (last - first > distance / 2) {
+    prefetchParents(set, last[-1 - distance / 2]);
+  }
+}
+
+static inline void kruskalPrefetch(DisjointSet &set, EdgeIt first,
+                                   EdgeIt last, u64 N, bool doSort,
+                                   Edges &mst,
+                                   int distance = PREFETCH_DISTANCE) {
+  if (doSort) std::sort(first, last);
+
+  for (EdgeIt it = first; it < last; it++) {
+    prefetchAhead(set, it, last, distance);
+    if (addEdgeToMst(set, *it, mst) && (mst.size() == N - 1)) break;
+  }
+}
+
+// the filtered edges are replaced by the ones at the end of the range, so
+// both ends are prefetched
+static inline EdgeIt filterAllPrefetch(DisjointSet &set, EdgeIt first,
+                                       EdgeIt last,
+                                       int distance = PREFETCH_DISTANCE) {
+  while (first < last) {
+    prefetchAhead(set, first, last, distance);
+    prefetchBehind(set, first, last, distance);
+    const Edge &e = *first;
+    if (filter(set, e.a, e.b)) {
+      *first = *(--last);
+    } else {
+      ++first;
+    }
+  }
+  return last;
+}
+
+static inline void prefetchFilterKruskal(
+    DisjointSet &set, EdgeIt first, EdgeIt last, u64 N, Edges &mst,
+    int distance = PREFETCH_DISTANCE,
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) {
+    return kruskalPrefetch(set, first, last, N, true, mst, distance);
+  }
+
+  EdgeIt pivotPos = pickRandomPivot(first, last);
+  EdgeIt mid = partition(first, last, pivotPos->w);
+
+  prefetchFilterKruskal(set, first, mid, N, mst, distance, baseCase);
+
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos, mst);
+  if (mst.size() < N - 1) {
+    last = filterAllPrefetch(set, mid, last, distance);
+    prefetchFilterKruskal(set, mid, last, N, mst, distance, baseCase);
+  }
+}
+
+static inline Edges prefetchFilterKruskal(
+    Edges &edges, u64 N, int distance = PREFETCH_DISTANCE,
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  prefetchFilterKruskal(set, edges.begin(), edges.end(), N, mst, distance,
+                        baseCase);
+  return mst;
+}
+
+TEST_CASE("prefetchFilterKruskal") {
+  for (int distance : {0, 1, 16}) {
+    checkAgainstKruskal(
+        [distance](Edges &edges, int N) {
+          return prefetchFilterKruskal(edges, N, distance);
+        },
+        79, {0});
+  }
+}
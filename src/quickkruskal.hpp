@@ -0,0 +1,69 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+
+// Quick-Kruskal: kruskal() on top of incremental quicksort (Paredes, Navarro).
+// the stack holds the positions of the pivots still to reach, every edge
+// before the top is lighter than every edge after it, so only the prefix of
+// the edges scanned before the MST is complete gets sorted.
+// unlike filterKruskal no edge is filtered
+static inline void quickKruskal(DisjointSet &set, EdgeIt first, EdgeIt last,
+                                u64 N, Edges &mst,
+                                u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  static Random rnd(31);
+  u64 M = last - first;
+  std::vector<u64> stack = {M};
+  u64 i = 0;  // edges before i are already scanned
+
+  while (i < M && mst.size() < N - 1) {
+    u64 end = stack.back();
+    if (end == i) {
+      stack.pop_back();
+      continue;
+    }
+
+    EdgeIt lo = first + i, hi = first + end;
+    if (end - i < baseCase) {
+      kruskal(set, lo, hi, N, true, mst);
+      i = end;
+      stack.pop_back();
+      continue;
+    }
+
+    // [i, lt) is the next range, [lt, gt) has the weight of the pivot
+    auto mids = partitionFat(lo, hi, lo[rnd.getULong(end - i)].w);
+    u64 lt = mids.first - first, gt = mids.second - first;
+    if (lt == i && gt == end) {
+      kruskal(set, lo, hi, N, false, mst);
+      i = end;
+      stack.pop_back();
+      continue;
+    }
+    stack.push_back(gt);
+    stack.push_back(lt);
+  }
+}
+
+static inline Edges quickKruskal(Edges &edges, u64 N,
+                                 u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  quickKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst;
+}
+
+TEST_CASE("quickKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return quickKruskal(edges, N); }, 83);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+
+// Filter-Kruskal where the partitioning is a MSD radix step on the bits of the
+// weights: the bit pattern of a non negative float sorts like the float, so
+// the buckets of a digit are already in order and no pivot is needed
+
+static const int RADIX_BITS = 8;
+static const int RADIX_BUCKETS = 1 << RADIX_BITS;
+static const int RADIX_TOP_SHIFT = 32 - RADIX_BITS;
+static const u64 RADIX_BASE_CASE = 1000;
+
+static inline u32 weightBits(float w) {
+  u32 bits;
+  std::memcpy(&bits, &w, sizeof(bits));
+  return bits;
+}
+
+static inline int radixDigit(const Edge &e, int shift) {
+  return (weightBits(e.w) >> shift) & (RADIX_BUCKETS - 1);
+}
+
+// the weights must be non negative, shift is the position of the digit used
+// by this step, the higher digits are equal for all the edges in the range
+static inline void radixFilterKruskal(DisjointSet &set, EdgeIt first,
+                                      EdgeIt last, int N, Edges &mst,
+                                      u64 baseCase = RADIX_BASE_CASE,
+                                      int shift = RADIX_TOP_SHIFT) {
+  const int K = RADIX_BUCKETS;
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  // skip the digits where all the edges fall in the same bucket
+  u64 count[K];
+  for (; shift >= 0; shift -= RADIX_BITS) {
+    std::fill(count, count + K, 0);
+    for (EdgeIt it = first; it < last; ++it) count[radixDigit(*it, shift)]++;
+    if (count[radixDigit(*first, shift)] != M) break;
+  }
+
+  // no digit left, the weights are all equal
+  if (shift < 0) return kruskal(set, first, last, N, false, mst);
+
+  u64 bucketStart[K + 1] = {0};
+  for (int b = 0; b < K; b++) bucketStart[b + 1] = bucketStart[b] + count[b];
+
+  // in place distribution (American flag sort): every swap puts at least one
+  // edge in its final bucket
+  u64 next[K];
+  std::copy(bucketStart, bucketStart + K, next);
+  for (int b = 0; b < K; b++) {
+    while (next[b] < bucketStart[b + 1]) {
+      int d = radixDigit(first[next[b]], shift);
+      if (d == b)
+        next[b]++;
+      else
+        std::swap(first[next[b]], first[next[d]++]);
+    }
+  }
+
+  for (int b = 0; b < K; b++) {
+    if (mst.size() == N - 1) return;
+    EdgeIt bucketFirst = first + bucketStart[b];
+    EdgeIt bucketLast = first + bucketStart[b + 1];
+    if (bucketFirst == bucketLast) continue;
+    if (b > 0) bucketLast = filterAll(set, bucketFirst, bucketLast);
+    radixFilterKruskal(set, bucketFirst, bucketLast, N, mst, baseCase,
+                       shift - RADIX_BITS);
+  }
+}
+
+static inline Edges radixFilterKruskal(Edges &edges, int N,
+                                       u64 baseCase = RADIX_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  radixFilterKruskal(set, edges.begin(), edges.end(), N, mst, baseCase);
+  return mst;
+}
+
+TEST_CASE("radixFilterKruskal") {
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return radixFilterKruskal(edges, N); }, 61);
+}
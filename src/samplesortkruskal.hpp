@@ -0,0 +1,135 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/checkmst.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+
+// Filter-Kruskal on top of Super Scalar Sample Sort (Sanders, Winkel)
+
+static const int SAMPLESORT_LOG_BUCKETS = 8;
+static const int SAMPLESORT_BUCKETS = 1 << SAMPLESORT_LOG_BUCKETS;
+static const int SAMPLESORT_OVERSAMPLING = 4;
+static const u64 SAMPLESORT_BASE_CASE = 4096;
+
+// implicit binary search tree over the splitters, every element finds its
+// bucket in exactly SAMPLESORT_LOG_BUCKETS steps without any branch.
+// bucket i contains the weights in (splitter[i - 1], splitter[i]]
+struct SampleSortClassifier {
+  static const int K = SAMPLESORT_BUCKETS;
+  float tree[K];  // tree[1 .. K-1], tree[j] has children 2j and 2j+1
+
+  // splitters must be sorted and have size K - 1
+  void build(const std::vector<float> &splitters) {
+    assert(splitters.size() == K - 1);
+    build(splitters, 1, 0, K - 1);
+  }
+
+  inline int classify(float w) const {
+    int j = 1;
+    for (int l = 0; l < SAMPLESORT_LOG_BUCKETS; l++) {
+      j = 2 * j + (tree[j] < w);
+    }
+    return j - K;
+  }
+
+ private:
+  void build(const std::vector<float> &splitters, int j, int lo, int hi) {
+    if (lo >= hi) return;
+    int mid = (lo + hi) / 2;
+    tree[j] = splitters[mid];
+    build(splitters, 2 * j, lo, mid);
+    build(splitters, 2 * j + 1, mid + 1, hi);
+  }
+};
+
+// picks K - 1 splitters from a sorted random sample of the edge weights
+static inline std::vector<float> pickSplitters(EdgeIt first, EdgeIt last) {
+  static Random rnd(31);
+  const int K = SAMPLESORT_BUCKETS;
+  u64 M = last - first;
+
+  std::vector<float> sample(SAMPLESORT_OVERSAMPLING * K);
+  for (float &w : sample) w = first[rnd.getULong(M)].w;
+  std::sort(sample.begin(), sample.end());
+
+  std::vector<float> splitters(K - 1);
+  for (int i = 0; i < K - 1; i++) {
+    splitters[i] = sample[(i + 1) * SAMPLESORT_OVERSAMPLING - 1];
+  }
+  return splitters;
+}
+
+// buffer and oracle have the same size of the edge list and are indexed by
+// the same positions, they are shared between all recursion levels
+static inline void sampleSortKruskal(DisjointSet &set, EdgeIt first,
+                                     EdgeIt last, int N, Edges &mst,
+                                     EdgeIt buffer, u8 *oracle,
+                                     u64 baseCase = SAMPLESORT_BASE_CASE) {
+  const int K = SAMPLESORT_BUCKETS;
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  SampleSortClassifier classifier;
+  classifier.build(pickSplitters(first, last));
+
+  // assign buckets, the bucket ids are stored in the oracle so that the
+  // distribution does not need to classify the elements again
+  u64 bucketStart[K + 1] = {0};
+  for (u64 i = 0; i < M; i++) {
+    int bucket = classifier.classify(first[i].w);
+    oracle[i] = bucket;
+    bucketStart[bucket + 1]++;
+  }
+
+  // all the elements ended up in the same bucket, the weights are all equal
+  // or almost, so sampling is not going to split them
+  for (int b = 0; b < K; b++) {
+    if (bucketStart[b + 1] == M) return kruskal(set, first, last, N, true, mst);
+  }
+
+  for (int b = 0; b < K; b++) bucketStart[b + 1] += bucketStart[b];
+
+  u64 writePos[K];
+  std::copy(bucketStart, bucketStart + K, writePos);
+  for (u64 i = 0; i < M; i++) buffer[writePos[oracle[i]]++] = first[i];
+  std::copy(buffer, buffer + M, first);
+
+  for (int b = 0; b < K; b++) {
+    if (mst.size() == N - 1) return;
+    EdgeIt bucketFirst = first + bucketStart[b];
+    EdgeIt bucketLast = first + bucketStart[b + 1];
+    if (b > 0) bucketLast = filterAll(set, bucketFirst, bucketLast);
+    sampleSortKruskal(set, bucketFirst, bucketLast, N, mst,
+                      buffer + bucketStart[b], oracle + bucketStart[b],
+                      baseCase);
+  }
+}
+
+static inline Edges sampleSortKruskal(Edges &edges, int N,
+                                      u64 baseCase = SAMPLESORT_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  Edges buffer(edges.size());
+  std::vector<u8> oracle(edges.size());
+  sampleSortKruskal(set, edges.begin(), edges.end(), N, mst, buffer.begin(),
+                    oracle.data(), baseCase);
+  return mst;
+}
+
+TEST_CASE("sampleSortKruskal") {
+  // with one level the weights are equal and can not be split by the
+  // splitters
+  checkAgainstKruskal(
+      [](Edges &edges, int N) { return sampleSortKruskal(edges, N); }, 5,
+      {0, 1});
+}
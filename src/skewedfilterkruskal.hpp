@@ -0,0 +1,87 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+
+// Skewed Filter-Kruskal: a random graph with random weights becomes connected
+// after about N ln(N) / 2 of its lightest edges, so the first partition only
+// keeps k times that many edges, where k should be slightly bigger than 1 to
+// leave some headroom for heavier MSTs.
+// with skewInner the inner recursion levels are skewed in the same way,
+// based on the number of MST edges still missing, otherwise they are split
+// in half. the split point is estimated with a sample of sqrt(M) weights
+static inline void skewedFilterKruskal(DisjointSet &set, EdgeIt first,
+                                       EdgeIt last, int N, Edges &mst,
+                                       double k, bool skewInner,
+                                       u64 baseCase = FILTER_KRUSKAL_BASE_CASE,
+                                       bool skew = true) {
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  double q = 0.5;
+  if (skew) {
+    double missing = N - 1 - mst.size();
+    q = std::min(q, k * missing * std::log(missing + 1) / 2 / M);
+  }
+
+  float pivotVal = pickSampleQuantile(first, last, q);
+  EdgeIt mid = partition(first, last, pivotVal);
+  if (mid == first) {
+    // the pivot is the lightest weight, move the edges equal to it left
+    mid = std::partition(first, last,
+                         [pivotVal](const Edge &e) { return e.w <= pivotVal; });
+    if (mid == last) return kruskal(set, first, last, N, false, mst);
+  }
+
+  skewedFilterKruskal(set, first, mid, N, mst, k, skewInner, baseCase,
+                      skewInner);
+
+  if (mst.size() < N - 1) {
+    last = filterAll(set, mid, last);
+    skewedFilterKruskal(set, mid, last, N, mst, k, skewInner, baseCase,
+                        skewInner);
+  }
+}
+
+static inline Edges skewedFilterKruskal(
+    Edges &edges, int N, double k = 1.1, bool skewInner = true,
+    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  skewedFilterKruskal(set, edges.begin(), edges.end(), N, mst, k, skewInner,
+                      baseCase);
+  return mst;
+}
+
+TEST_CASE("skewedFilterKruskal") {
+  Random rnd(29);
+  int N = 2000;
+  Edges edges;
+  randomGraph(rnd, N, 200000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  for (bool skewInner : {false, true}) {
+    for (double k : {0.1, 1.1, 4.0}) {
+      copy = edges;
+      Edges mst = skewedFilterKruskal(copy, N, k, skewInner);
+      CHECK(mst.size() == N - 1);
+      CHECK(sortedWeights(mst) == sortedWeights(expected));
+    }
+  }
+
+  // a single weight can not be split
+  for (Edge &e : edges) e.w = 0.5;
+  CHECK(skewedFilterKruskal(edges, N).size() == N - 1);
+}
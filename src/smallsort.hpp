@@ -0,0 +1,121 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+
+// sorts for the small ranges of the kruskal() base cases, by weight:
+//   up to SMALL_SORT_INSERTION_MAX edges: insertion sort
+//   up to SMALL_SORT_MAX edges: LSD radix sort on the weight bits
+//   bigger ranges: std::sort
+// the radix sort pays for its digit counts only from about 64 edges on
+
+static const u64 SMALL_SORT_INSERTION_MAX = 64;
+static const u64 SMALL_SORT_MAX = 1024;
+static const int SMALL_SORT_RADIX_BITS = 8;
+
+// an edge lighter than the first one is moved to the front at once, so the
+// inner loop needs no bound check
+static inline void insertionSort(EdgeIt first, EdgeIt last) {
+  for (EdgeIt it = first + 1; it < last; it++) {
+    Edge e = *it;
+    EdgeIt pos = it;
+    if (e.w < first->w) {
+      std::move_backward(first, it, it + 1);
+      pos = first;
+    } else {
+      for (; e.w < (pos - 1)->w; pos--) *pos = *(pos - 1);
+    }
+    *pos = e;
+  }
+}
+
+// the bits of a float mapped to an unsigned int with the same order, also for
+// negative weights
+static inline u32 orderedBits(float w) {
+  u32 bits;
+  std::memcpy(&bits, &w, sizeof(bits));
+  return bits ^ ((bits >> 31) ? 0xffffffffu : 0x80000000u);
+}
+
+// buffer has room for the range, the digits where all the edges are equal
+// are skipped
+static inline void radixSortSmall(EdgeIt first, EdgeIt last, Edge *buffer) {
+  const int K = 1 << SMALL_SORT_RADIX_BITS;
+  int n = last - first;
+  u32 keys[SMALL_SORT_MAX], keyBuffer[SMALL_SORT_MAX];
+  for (int i = 0; i < n; i++) keys[i] = orderedBits(first[i].w);
+
+  Edge *from = &*first, *to = buffer;
+  u32 *keyFrom = keys, *keyTo = keyBuffer;
+  for (int shift = 0; shift < 32; shift += SMALL_SORT_RADIX_BITS) {
+    int count[K] = {0};
+    for (int i = 0; i < n; i++) count[(keyFrom[i] >> shift) & (K - 1)]++;
+    if (count[(keyFrom[0] >> shift) & (K - 1)] == n) continue;
+
+    int pos = 0;
+    for (int b = 0; b < K; b++) {
+      int c = count[b];
+      count[b] = pos;
+      pos += c;
+    }
+    for (int i = 0; i < n; i++) {
+      int j = count[(keyFrom[i] >> shift) & (K - 1)]++;
+      to[j] = from[i];
+      keyTo[j] = keyFrom[i];
+    }
+    std::swap(from, to);
+    std::swap(keyFrom, keyTo);
+  }
+  if (from != &*first) std::copy(from, from + n, first);
+}
+
+// sorts the edges by weight, choosing the kernel by the size of the range
+static inline void sortEdges(EdgeIt first, EdgeIt last) {
+  u64 M = last - first;
+  if (M <= 1) return;
+  if (M <= SMALL_SORT_INSERTION_MAX) return insertionSort(first, last);
+  if (M <= SMALL_SORT_MAX) {
+    Edge buffer[SMALL_SORT_MAX];
+    return radixSortSmall(first, last, buffer);
+  }
+  std::sort(first, last);
+}
+
+// any other edge type
+template <class It>
+static inline void sortEdges(It first, It last) {
+  std::sort(first, last);
+}
+
+TEST_CASE("sortEdges") {
+  Random rnd(97);
+  for (int n : {0, 1, 2, 5, 16, 63, 64, 65, 100, 1000, 1024, 1025}) {
+    for (int levels : {0, 3}) {
+      Edges edges(n);
+      for (Edge &e : edges) {
+        e = Edge(rnd.getInt(100), rnd.getInt(100), rnd.getFloat() - 0.5f);
+        if (levels > 0) e.w = rnd.getInt(levels);
+      }
+      Edges copy = edges;
+      sortEdges(edges.begin(), edges.end());
+      CHECK(std::is_sorted(edges.begin(), edges.end()));
+
+      // the same edges, with their endpoints
+      auto byAll = [](const Edge &x, const Edge &y) {
+        return x.w != y.w ? x.w < y.w : Edge::compareNodes(x, y);
+      };
+      std::sort(copy.begin(), copy.end(), byAll);
+      std::sort(edges.begin(), edges.end(), byAll);
+      bool same = true;
+      for (int i = 0; i < n; i++) {
+        same &= Edge::sameNodes(edges[i], copy[i]) && edges[i].w == copy[i].w;
+      }
+      CHECK(same);
+    }
+  }
+}
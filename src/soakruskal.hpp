@@ -0,0 +1,116 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "keykruskal.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+#include "utils/random.hpp"
+#include "utils/soaedges.hpp"
+
+// partition, filterAll, kruskal() and filterKruskal on SoaEdges, the ranges
+// are [first, last) positions in the arrays
+
+// Hoare partition, the scans only read the weights
+static inline u64 partition(SoaEdges &edges, u64 first, u64 last,
+                            float pivotVal) {
+  const float *w = edges.w.data();
+  while (true) {
+    while (first < last && w[first] < pivotVal) first++;
+    while (first < last && !(w[last - 1] < pivotVal)) last--;
+    if (first == last) return first;
+    edges.swap(first++, --last);
+  }
+}
+
+static inline u64 filterAll(DisjointSet &set, SoaEdges &edges, u64 first,
+                            u64 last) {
+  while (first < last) {
+    if (filter(set, edges.a[first], edges.b[first])) {
+      edges.set(first, edges[--last]);
+    } else {
+      ++first;
+    }
+  }
+  return last;
+}
+
+// the range is not reordered, the edges are visited in the order of their
+// sorted keys. keys and buffer have room for last - first keys
+static inline void kruskal(DisjointSet &set, SoaEdges &edges, u64 first,
+                           u64 last, int N, Edges &mst, EdgeKey *keys,
+                           EdgeKey *buffer) {
+  u64 M = last - first;
+  if (M == 0) return;
+  for (u64 i = 0; i < M; i++) {
+    keys[i] = (u64(weightBits(edges.w[first + i])) << 32) | (first + i);
+  }
+  sortKeys(keys, keys + M, buffer);
+  for (u64 i = 0; i < M; i++) {
+    if (addEdgeToMst(set, edges[keyIndex(keys[i])], mst) &&
+        mst.size() == N - 1)
+      break;
+  }
+}
+
+// keys and buffer have room for baseCase keys, the weights must be non
+// negative and there must be less than 2^32 edges
+static inline void soaFilterKruskal(DisjointSet &set, SoaEdges &edges,
+                                    u64 first, u64 last, int N, Edges &mst,
+                                    EdgeKey *keys, EdgeKey *buffer,
+                                    u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  static Random rnd(31);
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) {
+    return kruskal(set, edges, first, last, N, mst, keys, buffer);
+  }
+
+  edges.swap(first, first + rnd.getULong(M));
+  Edge pivot = edges[first++];
+  u64 mid = partition(edges, first, last, pivot.w);
+
+  soaFilterKruskal(set, edges, first, mid, N, mst, keys, buffer, baseCase);
+
+  if (mst.size() < N - 1) addEdgeToMst(set, pivot, mst);
+  if (mst.size() < N - 1) {
+    last = filterAll(set, edges, mid, last);
+    soaFilterKruskal(set, edges, mid, last, N, mst, keys, buffer, baseCase);
+  }
+}
+
+static inline Edges soaFilterKruskal(SoaEdges &edges, int N,
+                                     u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  DisjointSet set(N);
+  Edges mst;
+  std::vector<EdgeKey> keys(baseCase), buffer(baseCase);
+  soaFilterKruskal(set, edges, 0, edges.size(), N, mst, keys.data(),
+                   buffer.data(), baseCase);
+  return mst;
+}
+
+TEST_CASE("soaFilterKruskal") {
+  Random rnd(71);
+  int N = 2000;
+  for (int levels : {0, 300}) {
+    SoaEdges edges;
+    randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+    if (levels > 0) quantizeWeights(edges, 1.0, levels);
+    Edges copy = edges.toEdges();
+    Edges expected = kruskal(copy, N);
+
+    u64 mid = partition(edges, 0, edges.size(), 0.5);
+    for (u64 i = 0; i < edges.size(); i++) {
+      CHECK((edges.w[i] < 0.5) == (i < mid));
+    }
+
+    Edges mst = soaFilterKruskal(edges, N);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(expected));
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+
+// semi-streaming MST: the edges arrive in chunks and only the minimum
+// spanning forest of the edges seen so far is kept.
+// the MSF of forest + chunk is the MSF of all the edges seen, since an edge
+// dropped from a forest is the heaviest of some cycle and stays out of the MSF
+// of any superset, so the memory used is O(N + chunk)
+struct StreamingKruskal {
+  u64 N;
+  u64 baseCase;
+  Edges forest;  // sorted by weight
+
+  StreamingKruskal(u64 N, u64 baseCase = FILTER_KRUSKAL_BASE_CASE)
+      : N(N), baseCase(baseCase) {}
+
+  // forest + chunk only lives during the call, between the calls only the
+  // forest is kept
+  void addChunk(const Edge *first, const Edge *last) {
+    Edges merged;
+    merged.reserve(forest.size() + (last - first));
+    merged.assign(forest.begin(), forest.end());
+    merged.insert(merged.end(), first, last);
+
+    DisjointSet set(N);
+    forest.clear();
+    filterKruskal(set, merged.begin(), merged.end(), N, forest, baseCase);
+  }
+
+  void addChunk(const Edges &chunk) {
+    addChunk(chunk.data(), chunk.data() + chunk.size());
+  }
+
+  // the MSF of all the edges added so far
+  const Edges &msf() const { return forest; }
+
+  bool complete() const { return forest.size() == N - 1; }
+};
+
+TEST_CASE("StreamingKruskal") {
+  Random rnd(59);
+  int N = 2000;
+  Edges edges;
+  randomGraph(rnd, N, 100000, 1.0, edges);
+  Edges copy = edges;
+  Edges expected = kruskal(copy, N);
+
+  StreamingKruskal stream(N);
+  u64 chunkSize = 7000;
+  for (u64 i = 0; i < edges.size(); i += chunkSize) {
+    u64 end = std::min(i + chunkSize, (u64)edges.size());
+    stream.addChunk(edges.data() + i, edges.data() + end);
+    CHECK(stream.msf().size() < N);
+
+    // the forest of a prefix is the MSF of that prefix
+    if (i == 0) {
+      Edges prefix(edges.begin(), edges.begin() + end);
+      CHECK(sortedWeights(stream.msf()) ==
+            sortedWeights(kruskal(prefix, N)));
+    }
+  }
+  CHECK(stream.complete());
+  CHECK(sortedWeights(stream.msf()) == sortedWeights(expected));
+}
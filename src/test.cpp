@@ -1,5 +1,27 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include "adaptivekruskal.hpp"
+#include "calibrate.hpp"
+#include "dualpivotkruskal.hpp"
+#include "externalkruskal.hpp"
+#include "fatfilterkruskal.hpp"
+#include "filterkruskal.hpp"
 #include "graphgen/randomgraphs.hpp"
-#include "unionfind.hpp"
\ No newline at end of file
+#include "histogramkruskal.hpp"
+#include "keykruskal.hpp"
+#include "msfkruskal.hpp"
+#include "mstsink.hpp"
+#include "parallelfilterkruskal.hpp"
+#include "parallelpartition.hpp"
+#include "parallelsamplesortkruskal.hpp"
+#include "prefetchkruskal.hpp"
+#include "quickkruskal.hpp"
+#include "radixkruskal.hpp"
+#include "samplesortkruskal.hpp"
+#include "skewedfilterkruskal.hpp"
+#include "smallsort.hpp"
+#include "soakruskal.hpp"
+#include "streamingkruskal.hpp"
+#include "unionfind.hpp"
+#include "warmkruskal.hpp"
@@ -2,28 +2,42 @@
 
 #include <doctest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <limits>
 #include <memory>
+#include <type_traits>
 
 #include "utils/base.hpp"
+#include "utils/parallel.hpp"
 
-struct DisjointSet {
-  u32 N;
-  std::unique_ptr<u32[]> p;  // parent ids
-  std::unique_ptr<u32[]> r;  // ranks
+// T is the type of the node ids, a narrower type makes the arrays smaller
+template <class T>
+struct BasicDisjointSet {
+  u64 N;
+  std::unique_ptr<T[]> p;  // parent ids
+  std::unique_ptr<u8[]> r;  // ranks, at most log2(N) so a byte is enough
 
-  DisjointSet(u32 N) : N(N), p(new u32[N]), r(new u32[N]) {
+  BasicDisjointSet(u64 N) : N(N), p(new T[N]), r(new u8[N]()) {
     // every node starts out in its own set
     for (std::size_t i = 0; i < N; i++) p[i] = i;
   }
 
+  // puts every node back in its own set
+  void reset() {
+    for (std::size_t i = 0; i < N; i++) p[i] = i;
+    std::fill(r.get(), r.get() + N, 0);
+  }
+
   // finds the parent of x
   // iterative path compression
-  inline u32 find(u32 x) {
+  inline T find(T x) {
     assert(x < N);
-    u32 root = x;
+    T root = x;
     while (root != p[root]) root = p[root];
     while (x != root) {
-      u32 temp = p[x];
+      T temp = p[x];
       p[x] = root;
       x = temp;
     }
@@ -31,12 +45,12 @@ struct DisjointSet {
   }
 
   // checks if a and b have the same parent
-  bool compare(u32 a, u32 b) {
+  bool compare(T a, T b) {
     assert(a < N);
     assert(b < N);
 
-    u32 pa = p[a];
-    u32 pb = p[b];
+    T pa = p[a];
+    T pb = p[b];
     if (pa == pb) return true;
 
     p[a] = pa = find(pa);
@@ -50,12 +64,12 @@ struct DisjointSet {
   //   true if find(a) != find(b)
   //   false otherwise
   // union by rank
-  bool checkMerge(u32 a, u32 b) {
+  bool checkMerge(T a, T b) {
     assert(a < N);
     assert(b < N);
 
-    u32 pa = p[a];
-    u32 pb = p[b];
+    T pa = p[a];
+    T pb = p[b];
     if (pa == pb) return false;
 
     p[a] = pa = find(pa);
@@ -70,24 +84,42 @@ struct DisjointSet {
     return true;
   }
 
+  // finds the root of x without path compression, since it never writes it
+  // can be called by many threads at once while no set is being merged
+  inline T findConst(T x) const {
+    assert(x < N);
+    while (x != p[x]) x = p[x];
+    return x;
+  }
+
+  // hints the cache to load the parent of x, and in a second step the parent
+  // of the parent, for the edges that are going to be checked soon
+  inline void prefetch(T x) const { __builtin_prefetch(&p[x]); }
+  inline void prefetchParent(T x) const { __builtin_prefetch(&p[p[x]]); }
+
+  // read-only version of compare
+  bool compareConst(T a, T b) const {
+    return findConst(a) == findConst(b);
+  }
+
   // alternative find implementations:
 
   // naive
-  u32 find0(u32 x) {
+  T find0(T x) {
     if (p[x] == x) return x;
     return find0(p[x]);
   }
 
   // recursive path compression
-  u32 find1(u32 x) {
+  T find1(T x) {
     if (p[x] == x) return x;
     return (p[x] = find1(p[x]));
   }
 
   // path splitting
-  u32 find3(u32 x) {
+  T find3(T x) {
     while (p[x] != x) {
-      u32 parent = p[x];
+      T parent = p[x];
       p[x] = p[p[x]];
       x = parent;
     }
@@ -95,7 +127,7 @@ struct DisjointSet {
   }
 
   // path halving
-  u32 find4(u32 x) {
+  T find4(T x) {
     while (p[x] != x) {
       p[x] = p[p[x]];
       x = p[x];
@@ -104,6 +136,99 @@ struct DisjointSet {
   }
 };
 
+typedef BasicDisjointSet<u32> DisjointSet;
+
+// union find for the node ids of the edge type E
+template <class E>
+using EdgeDisjointSet =
+    BasicDisjointSet<std::make_unsigned_t<typename E::NodeIdType>>;
+
+// read-only snapshot of a DisjointSet where every node points directly to its
+// root, so comparing two nodes costs two loads and many threads can do it at
+// the same time. it must be refreshed after the sets are merged
+struct FrozenDisjointSet {
+  u32 N;
+  std::unique_ptr<u32[]> root;
+
+  FrozenDisjointSet(u32 N) : N(N), root(new u32[N]) {}
+
+  // flattens the parent array of set, every thread handles a range of nodes
+  void refresh(const DisjointSet &set, int nThreads) {
+    assert(set.N == N);
+    parallelRun(nThreads, [&](int t) {
+      u32 last = chunkStart(N, nThreads, t + 1);
+      for (u32 x = chunkStart(N, nThreads, t); x < last; x++) {
+        root[x] = set.findConst(x);
+      }
+    });
+  }
+
+  bool compare(u32 a, u32 b) const {
+    assert(a < N);
+    assert(b < N);
+    return root[a] == root[b];
+  }
+};
+
+// union find that many threads can merge at the same time. a root is linked
+// with a CAS on its parent, always under the root with the smaller id so that
+// no cycle can form, and find halves the paths with CAS too. T is the type of
+// the node ids, N must fit it
+template <class T>
+struct BasicConcurrentDisjointSet {
+  u64 N;
+  std::unique_ptr<std::atomic<T>[]> p;  // parent ids
+
+  BasicConcurrentDisjointSet(u64 N, int nThreads = 1) : N(N) {
+    if (N > 0 && N - 1 > std::numeric_limits<T>::max()) {
+      std::cerr << "Too many nodes for the node id type" << std::endl;
+      unreachable();
+    }
+    p.reset(new std::atomic<T>[N]);
+    parallelRun(nThreads, [&](int t) {
+      u64 last = chunkStart(N, nThreads, t + 1);
+      for (u64 x = chunkStart(N, nThreads, t); x < last; x++) {
+        p[x].store(x, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  T find(T x) {
+    assert(x < N);
+    while (true) {
+      T parent = p[x].load();
+      if (parent == x) return x;
+      T grandparent = p[parent].load();
+      // fails only if another thread moved x up already
+      if (parent != grandparent) {
+        p[x].compare_exchange_weak(parent, grandparent);
+      }
+      x = grandparent;
+    }
+  }
+
+  // returns true if a and b were in different sets and merges them
+  bool checkMerge(T a, T b) {
+    assert(a < N);
+    assert(b < N);
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) return false;
+      if (a < b) std::swap(a, b);
+      // a may have stopped being a root since the find
+      T expected = a;
+      if (p[a].compare_exchange_strong(expected, b)) return true;
+    }
+  }
+};
+
+typedef BasicConcurrentDisjointSet<u32> ConcurrentDisjointSet;
+
+template <class E>
+using EdgeConcurrentDisjointSet =
+    BasicConcurrentDisjointSet<std::make_unsigned_t<typename E::NodeIdType>>;
+
 TEST_CASE("DisjointSet") {
   int N = 10;
   DisjointSet s(N);
@@ -119,4 +244,58 @@ TEST_CASE("DisjointSet") {
   CHECK(s.checkMerge(4, 5));
   CHECK(s.checkMerge(0, 5));
   CHECK(s.checkMerge(2, 3) == false);
-}
\ No newline at end of file
+}
+
+TEST_CASE("FrozenDisjointSet") {
+  int N = 100;
+  DisjointSet s(N);
+  for (int i = 0; i + 2 < N; i += 3) s.checkMerge(i, i + 2);
+  s.checkMerge(0, 50);
+
+  FrozenDisjointSet frozen(N);
+  frozen.refresh(s, 3);
+  for (int a = 0; a < N; a++) {
+    for (int b = 0; b < N; b++) {
+      CHECK(frozen.compare(a, b) == s.compareConst(a, b));
+    }
+  }
+}
+
+TEST_CASE("ConcurrentDisjointSet") {
+  int N = 1000, M = 4000, nThreads = 4;
+  std::vector<std::pair<u32, u32>> pairs;
+  u64 seed = 1;
+  for (int i = 0; i < M; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    pairs.emplace_back((seed >> 33) % N, (seed >> 13) % N);
+  }
+
+  DisjointSet s(N);
+  u64 merges = 0;
+  for (auto &ab : pairs) merges += s.checkMerge(ab.first, ab.second);
+
+  ConcurrentDisjointSet c(N, nThreads);
+  std::vector<u64> threadMerges(nThreads, 0);
+  parallelRun(nThreads, [&](int t) {
+    u64 last = chunkStart(M, nThreads, t + 1);
+    for (u64 i = chunkStart(M, nThreads, t); i < last; i++) {
+      threadMerges[t] += c.checkMerge(pairs[i].first, pairs[i].second);
+    }
+  });
+  u64 concurrentMerges = 0;
+  for (u64 m : threadMerges) concurrentMerges += m;
+  CHECK(concurrentMerges == merges);
+
+  // 64 bit node ids
+  BasicConcurrentDisjointSet<u64> wide(N);
+  u64 wideMerges = 0;
+  for (auto &ab : pairs) wideMerges += wide.checkMerge(ab.first, ab.second);
+  CHECK(wideMerges == merges);
+
+  bool same = true;
+  for (int x = 0; x < N; x++) {
+    same &= (c.find(x) == c.find(0)) == s.compareConst(x, 0);
+    same &= (c.find(x) == c.find(x / 2)) == s.compareConst(x, x / 2);
+  }
+  CHECK(same);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <initializer_list>
+
+#include "../graphgen/randomgraphs.hpp"
+#include "../kruskal.hpp"
+#include "graph.hpp"
+#include "random.hpp"
+
+// the common test of the MST engines: engine(edges, N) runs on a copy of
+// random graphs with a long path, N = 2000 and 100000 edges, where the weights
+// are all different (levels = 0) or take the given number of values. the MST
+// must have the weights of the one of kruskal(). the same seed gives the same
+// graphs, so the variants of one engine can be checked on them one by one
+template <class F>
+static inline void checkAgainstKruskal(
+    F engine, u64 seed, std::initializer_list<int> levelsList = {0, 1, 300}) {
+  Random rnd(seed);
+  int N = 2000;
+  for (int levels : levelsList) {
+    Edges edges;
+    randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+    if (levels > 0) quantizeWeights(edges, 1.0, levels);
+    Edges copy = edges;
+    Edges expected = kruskal(copy, N);
+
+    copy = edges;
+    Edges mst = engine(copy, N);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(expected));
+  }
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <ostream>
 
 #include "base.hpp"
@@ -8,26 +9,35 @@ typedef std::pair<float, int> NodeEdge;
 typedef std::vector<NodeEdge> Node;
 typedef std::vector<Node> Graph;
 
-struct Edge {
-  int a, b;
-  float w;
+// edge with any node id and weight type, the MST code is templated on it
+template <class NodeId, class Weight>
+struct BasicEdge {
+  typedef NodeId NodeIdType;
+  typedef Weight WeightType;
 
-  inline Edge() {}
-  inline Edge(int a, int b, float w) : a(a), b(b), w(w) {}
+  NodeId a, b;
+  Weight w;
 
-  bool operator<(const Edge &other) const { return w < other.w; }
-  bool operator==(const Edge &other) const { return w == other.w; }
+  inline BasicEdge() {}
+  inline BasicEdge(NodeId a, NodeId b, Weight w) : a(a), b(b), w(w) {}
 
-  static bool compareNodes(const Edge &a, const Edge &b) {
+  bool operator<(const BasicEdge &other) const { return w < other.w; }
+  bool operator==(const BasicEdge &other) const { return w == other.w; }
+
+  static bool compareNodes(const BasicEdge &a, const BasicEdge &b) {
     return a.a == b.a ? (a.b < b.b) : (a.a < b.a);
   }
 
-  static bool sameNodes(const Edge &a, const Edge &b) {
+  static bool sameNodes(const BasicEdge &a, const BasicEdge &b) {
     return a.a == b.a && a.b == b.b;
   }
 };
 
-static inline std::ostream &operator<<(std::ostream &out, const Edge &edge) {
+typedef BasicEdge<int, float> Edge;
+
+template <class NodeId, class Weight>
+static inline std::ostream &operator<<(std::ostream &out,
+                                       const BasicEdge<NodeId, Weight> &edge) {
   out << edge.a << '-' << edge.b;
   return out;
 }
@@ -35,6 +45,17 @@ static inline std::ostream &operator<<(std::ostream &out, const Edge &edge) {
 typedef std::vector<Edge> Edges;
 typedef std::vector<Edge>::iterator EdgeIt;
 
+// sorted weights of the edge list, every MST of a graph has the same ones
+template <class E>
+static inline std::vector<typename E::WeightType> sortedWeights(
+    const std::vector<E> &edges) {
+  std::vector<typename E::WeightType> weights;
+  weights.reserve(edges.size());
+  for (const E &e : edges) weights.push_back(e.w);
+  std::sort(weights.begin(), weights.end());
+  return weights;
+}
+
 struct HalfEdge {
   int b;
   float w;  // b = other node, w = edge weight
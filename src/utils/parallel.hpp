@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "base.hpp"
+
+static inline int hardwareThreads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// runs fn(threadId) on nThreads threads, the calling thread is thread 0
+template <class F>
+static inline void parallelRun(int nThreads, F &&fn) {
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (int t = 1; t < nThreads; t++) threads.emplace_back(fn, t);
+  fn(0);
+  for (std::thread &thread : threads) thread.join();
+}
+
+// start of the t-th of nChunks contiguous chunks of [0, n)
+static inline u64 chunkStart(u64 n, int nChunks, int t) {
+  return n * t / nChunks;
+}
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "filterkruskal.hpp"
+#include "graphgen/randomgraphs.hpp"
+#include "kruskal.hpp"
+#include "partition.hpp"
+#include "pivot.hpp"
+#include "unionfind.hpp"
+#include "utils/graph.hpp"
+
+// MST of the same graph under weights that change a little between calls, as
+// in Held-Karp, where the weights are w + pi[a] + pi[b].
+// the edges are kept in the order of the last solve. the MST of the last call
+// is still a spanning tree, so no edge heavier than its heaviest edge under
+// the new weights can be in the new MST: the edges under it are moved to the
+// front with a stable partition that skips the prefix and the suffix already
+// on the right side. in the front the edges that moved a few places are
+// inserted back, only the ones that moved far are taken out, sorted and merged
+// back, so the work grows with how far the edges moved.
+// when too many edges moved the front is solved by filterKruskal, and sorted
+// again once the weights move less
+
+// if more than one edge in this many moved, the front is not repaired
+static const u64 WARM_MAX_DISPLACED_SHARE = 8;
+
+// an edge with its position in the edge list given by the user
+struct WarmEdge : Edge {
+  u32 id;
+
+  inline WarmEdge() {}
+  inline WarmEdge(const Edge &e, u32 id) : Edge(e), id(id) {}
+};
+
+// edges that are at most this many places after their place in the order are
+// moved there by insertion, the others are displaced
+static const u64 WARM_INSERT_DISTANCE = 16;
+
+// repairs the order of [first, last) in one pass: an edge a few places after
+// its place is inserted there, an edge much lighter than the edges before it
+// is taken out to displaced. an edge that became heavier is carried forward
+// one place at a time by the insertions of the edges it passes. the work
+// grows with the distance the edges moved. returns false, with all the edges
+// back in the range, if more than maxDisplaced edges are taken out, otherwise
+// sorted is the end of the sorted edges and moved the number of edges that
+// were inserted or taken out
+template <class It, class E>
+static inline bool extractDisplaced(It first, It last,
+                                    std::vector<E> &displaced,
+                                    u64 maxDisplaced, u64 &sorted,
+                                    u64 &moved) {
+  const u64 D = WARM_INSERT_DISTANCE;
+  u64 M = last - first;
+  u64 j = 0;  // the sorted edges are [0, j)
+  displaced.clear();
+  moved = 0;
+  for (u64 i = 0; i < M; i++) {
+    E e = first[i];
+    if (j == 0 || !(e.w < first[j - 1].w)) {
+      first[j++] = e;
+      continue;
+    }
+    moved++;
+    if (j <= D || !(e.w < first[j - D - 1].w)) {
+      u64 k = j++;
+      for (; k > 0 && e.w < first[k - 1].w; k--) first[k] = first[k - 1];
+      first[k] = e;
+      continue;
+    }
+    // the last sorted edge may be the one that moved
+    if (!(e.w < first[j - 2].w)) {
+      displaced.push_back(first[j - 1]);
+      first[j - 1] = e;
+    } else {
+      displaced.push_back(e);
+    }
+    if (displaced.size() > maxDisplaced) {
+      // [j, i + 1) is free
+      std::copy(displaced.begin(), displaced.end(), first + j);
+      return false;
+    }
+  }
+  sorted = j;
+  return true;
+}
+
+// merges the sorted displaced edges back into [first, first + sorted), the
+// range has room for them. only the edges heavier than the lightest displaced
+// one move
+template <class It, class E>
+static inline void mergeDisplaced(It first, u64 sorted,
+                                  const std::vector<E> &displaced) {
+  u64 i = sorted, d = displaced.size(), out = sorted + d;
+  while (d > 0) {
+    if (i > 0 && displaced[d - 1].w < first[i - 1].w) {
+      first[--out] = first[--i];
+    } else {
+      first[--out] = displaced[--d];
+    }
+  }
+}
+
+// filterKruskal that keeps every edge in the range: the filtered edges are
+// swapped to the end of their range instead of being overwritten
+template <class Set, class It, class Mst>
+static inline void warmFilterKruskal(Set &set, It first, It last, u64 N,
+                                     Mst &mst,
+                                     u64 baseCase = FILTER_KRUSKAL_BASE_CASE) {
+  u64 M = last - first;
+  if (M == 0) return;
+  if (M < baseCase) return kruskal(set, first, last, N, true, mst);
+
+  It pivotPos = pickRandomPivot(first, last);
+  It mid = partitionLess(first, last, pivotPos->w);
+
+  warmFilterKruskal(set, first, mid, N, mst, baseCase);
+
+  if (mst.size() < N - 1) addEdgeToMst(set, *pivotPos, mst);
+  if (mst.size() < N - 1) {
+    last = std::partition(mid, last, [&set](const auto &e) {
+      return !filter(set, e.a, e.b);
+    });
+    warmFilterKruskal(set, mid, last, N, mst, baseCase);
+  }
+}
+
+struct WarmKruskal {
+  u64 N;
+  u64 baseCase;
+  std::vector<WarmEdge> order;  // by weight up to the last cutoff, if sorted
+  std::vector<WarmEdge> tree;
+  std::vector<WarmEdge> displaced;
+  Edges mst;
+  bool sorted = false;  // the front is sorted under the last weights
+  float filteredDelta;  // largest weight change of the last filtered solve
+  u64 moved = 0;        // edges the last solve moved back in order
+
+  // the first solve is a filterKruskal that keeps all the edges, the order
+  // is sorted by the next one. the ids are u32, bigger edge lists abort, also
+  // in release builds
+  WarmKruskal(const Edges &edges, u64 N,
+              u64 baseCase = FILTER_KRUSKAL_BASE_CASE)
+      : N(N),
+        baseCase(baseCase),
+        filteredDelta(std::numeric_limits<float>::infinity()) {
+    if (edges.size() > UINT32_MAX) {
+      std::cerr << "WarmKruskal takes less than 2^32 edges" << std::endl;
+      unreachable();
+    }
+    order.reserve(edges.size());
+    for (u64 i = 0; i < edges.size(); i++) order.emplace_back(edges[i], i);
+    EdgeDisjointSet<WarmEdge> set(N);
+    warmFilterKruskal(set, order.begin(), order.end(), N, tree, baseCase);
+    mst.assign(tree.begin(), tree.end());
+  }
+
+  // weights[i] is the new weight of the i-th edge given to the constructor
+  const Edges &solve(const std::vector<float> &weights) {
+    auto first = order.begin();
+    u64 M = order.size();
+
+    // a forest of the last call does not bound the new MST
+    float cutoff = std::numeric_limits<float>::infinity();
+    if (N > 0 && tree.size() == N - 1) {
+      cutoff = -cutoff;
+      for (const WarmEdge &e : tree) cutoff = std::max(cutoff, weights[e.id]);
+    }
+    auto isLight = [cutoff](const WarmEdge &e) { return e.w <= cutoff; };
+
+    // the new weights, with the first heavy edge and the last light one
+    float delta = 0;
+    u64 lo = M, hi = 0;
+    for (u64 i = 0; i < M; i++) {
+      WarmEdge &e = order[i];
+      float w = weights[e.id];
+      delta = std::max(delta, std::abs(w - e.w));
+      e.w = w;
+      if (w <= cutoff) {
+        hi = i + 1;
+      } else if (lo == M) {
+        lo = i;
+      }
+    }
+    lo = std::min(lo, hi);
+
+    // the edges that can be in the MST are [0, light). an unsorted order does
+    // not need a stable partition
+    u64 light;
+    if (sorted) {
+      light = std::stable_partition(first + lo, first + hi, isLight) - first;
+    } else {
+      light = std::partition(first + lo, first + hi, isLight) - first;
+    }
+
+    EdgeDisjointSet<WarmEdge> set(N);
+    tree.clear();
+    moved = 0;
+    if (!sorted) {
+      // the order is left from a filtered solve, so the number of moved edges
+      // does not tell how much the weights changed: the weight change does
+      if (delta >= filteredDelta / 2) return filtered(set, light, delta);
+      sortEdges(first, first + light);
+      sorted = true;
+    } else {
+      u64 sortedEnd;
+      u64 maxDisplaced = light / WARM_MAX_DISPLACED_SHARE;
+      if (!extractDisplaced(first, first + light, displaced, maxDisplaced,
+                            sortedEnd, moved)) {
+        return filtered(set, light, delta);
+      }
+      sortEdges(displaced.begin(), displaced.end());
+      mergeDisplaced(first, sortedEnd, displaced);
+    }
+    kruskal(set, first, first + light, N, false, tree);
+    mst.assign(tree.begin(), tree.end());
+    return mst;
+  }
+
+  // solves the front with warmFilterKruskal, it is left unsorted
+  const Edges &filtered(EdgeDisjointSet<WarmEdge> &set, u64 light,
+                        float delta) {
+    sorted = false;
+    filteredDelta = delta;
+    warmFilterKruskal(set, order.begin(), order.begin() + light, N, tree,
+                      baseCase);
+    mst.assign(tree.begin(), tree.end());
+    return mst;
+  }
+};
+
+// Held-Karp weights: w + pi[a] + pi[b]
+static inline void potentialWeights(const Edges &edges,
+                                    const std::vector<float> &pi,
+                                    std::vector<float> &weights) {
+  weights.resize(edges.size());
+  for (u64 i = 0; i < edges.size(); i++) {
+    const Edge &e = edges[i];
+    weights[i] = e.w + pi[e.a] + pi[e.b];
+  }
+}
+
+TEST_CASE("WarmKruskal") {
+  Random rnd(107);
+  int N = 2000;
+  Edges edges;
+  randomGraphOneLong(rnd, N, 100000, 1.0, edges);
+
+  WarmKruskal warm(edges, N);
+  Edges copy = edges;
+  CHECK(sortedWeights(warm.mst) == sortedWeights(kruskal(copy, N)));
+  CHECK(!warm.sorted);
+
+  // the same weights: the order is sorted once, then only checked
+  std::vector<float> pi(N, 0), weights;
+  potentialWeights(edges, pi, weights);
+  warm.solve(weights);
+  CHECK(warm.sorted);
+  warm.solve(weights);
+  CHECK(warm.sorted);
+  CHECK(warm.moved == 0);
+  CHECK(warm.mst.size() == N - 1);
+
+  // small and big steps of the potentials, then steps small enough that the
+  // order can be repaired again
+  for (float step : {0.0001f, 0.001f, 0.01f, 0.1f, 1.0f, 1e-6f, 1e-6f}) {
+    for (float &p : pi) p += (rnd.getFloat() - 0.5f) * step;
+    potentialWeights(edges, pi, weights);
+    Edges moved = edges;
+    for (u64 i = 0; i < moved.size(); i++) moved[i].w = weights[i];
+
+    Edges mst = warm.solve(weights);
+    CHECK(mst.size() == N - 1);
+    CHECK(sortedWeights(mst) == sortedWeights(kruskal(moved, N)));
+  }
+  CHECK(warm.sorted);
+
+  // a disconnected graph is solved on all the edges
+  Edges forest(edges.begin(), edges.begin() + 100);
+  WarmKruskal warmForest(forest, N);
+  weights.assign(forest.size(), 0);
+  for (u64 i = 0; i < forest.size(); i++) weights[i] = forest[i].w * 2;
+  copy = forest;
+  CHECK(warmForest.solve(weights).size() == kruskal(copy, N).size());
+}
+
+TEST_CASE("extractDisplaced") {
+  // 1..40 where the 40 became too light for its place and the 0 heavy
+  Edges edges;
+  for (int i = 1; i < 40; i++) edges.emplace_back(0, 0, i);
+  edges.insert(edges.begin() + 2, Edge(0, 0, 40));
+  edges.insert(edges.begin() + 30, Edge(0, 0, 0));
+  Edges displaced;
+  u64 sorted, moved;
+  Edges copy = edges;
+  CHECK(!extractDisplaced(copy.begin(), copy.end(), displaced, 0, sorted,
+                          moved));
+  CHECK(sortedWeights(copy) == sortedWeights(edges));
+
+  // the 40 is carried to the end by the insertions, the 0 is too far
+  REQUIRE(extractDisplaced(edges.begin(), edges.end(), displaced, 1, sorted,
+                           moved));
+  CHECK(sorted == 40);
+  CHECK(displaced.size() == 1);
+  CHECK(moved == 38);
+  mergeDisplaced(edges.begin(), sorted, displaced);
+  bool inOrder = true;
+  for (int i = 0; i <= 40; i++) inOrder &= edges[i].w == i;
+  CHECK(inOrder);
+}